@@ -48,12 +48,55 @@ typedef struct PACKED ssd1306_bitmap_t {
 	uint8_t image[];
 } ssd1306_bitmap_t;
 
+typedef struct PACKED ssd1306_packed_t {
+	const union {
+		struct ssd1306_size_t;
+		ssd1306_size_t size;
+	};
+	// the offset of each page as 16 bits little endian, from the end of the offsets,
+	// followed by the pages, each one run-length encoded as in tools/pbm2pack.c;
+	// close to PackBits but not compatible with it, a run of n bytes has a control byte of n + 126
+	uint8_t data[];
+} ssd1306_packed_t;
+
+typedef struct PACKED ssd1306_view_t {
+	union {
+		struct ssd1306_size_t;
+		ssd1306_size_t size;
+	};
+	uint16_t stride; // bytes between two consecutive pages
+	uint8_t shift; // rows to skip within the first page
+	const uint8_t* image;
+} ssd1306_view_t;
+
 typedef struct PACKED ssd1306_glyph_t {
-	const uint8_t w;
-	const uint8_t h;
-	const uint8_t image[8];
+	const uint8_t w; // the advance, and the width of the image
+	const uint16_t offset; // of the page-major image, from the end of the glyph table
 } ssd1306_glyph_t;
 
+typedef struct PACKED ssd1306_font_range_t {
+	const uint32_t first; // the code point of the first glyph
+	const uint16_t count; // of consecutive code points
+	const uint16_t glyph; // index of the first glyph in the glyph table
+} ssd1306_font_range_t;
+
+/*
+	The layout generated by bdf2fnt: only the code points present are
+	stored, as sorted ranges into the glyph table which follows them. The
+	images come last, each bytes_cap(height) pages of w columns.
+*/
+typedef struct PACKED ssd1306_font_t {
+	const uint8_t height; // of every glyph, at most 32
+	const uint8_t baseline; // rows from the top down to the baseline, informational: text is aligned by its top
+	const uint16_t ranges_z; // number of ranges
+	const uint16_t glyphs_z; // number of glyphs, zero width ones fill small gaps
+	const ssd1306_font_range_t ranges[];
+} ssd1306_font_t;
+
+typedef struct PACKED ssd1306_pattern_t {
+	uint8_t image[8]; // eight columns of one page, repeated from the display origin
+} ssd1306_pattern_t;
+
 typedef enum {
 	ssd1306_interface_any,
 	ssd1306_interface_iic,
@@ -98,6 +141,34 @@ typedef enum {
 	ssd1306_status_int, // the internal status line
 } ssd1306_status_t;
 
+typedef enum {
+	ssd1306_rop_copy,    // target = source
+	ssd1306_rop_or,      // target |= source
+	ssd1306_rop_and,     // target &= source
+	ssd1306_rop_and_not, // target &= ~source
+	ssd1306_rop_xor,     // target ^= source
+} ssd1306_rop_t;
+
+typedef enum {
+	ssd1306_color_clear,
+	ssd1306_color_set,
+	ssd1306_color_invert,
+} ssd1306_color_t;
+
+typedef enum {
+	ssd1306_transform_none,
+	ssd1306_transform_mirror_h,   // left to right
+	ssd1306_transform_mirror_v,   // top to bottom
+	ssd1306_transform_rotate_90,  // clockwise
+	ssd1306_transform_rotate_180,
+	ssd1306_transform_rotate_270, // clockwise
+} ssd1306_transform_t;
+
+typedef enum {
+	ssd1306_lsb_first, // the leftmost pixel of a byte is bit 0, as in XBM
+	ssd1306_msb_first, // the leftmost pixel of a byte is bit 7, as in PBM
+} ssd1306_bit_order_t;
+
 typedef struct PACKED ssd1306_init_s {
 	struct PACKED {
 		bool free; // structure to be freed by ssd1306_init
@@ -106,21 +177,118 @@ typedef struct PACKED ssd1306_init_s {
 
 		bool flip;
 		bool invert;
+		bool portrait; // rotated by 90 degrees, the raster is 32x128 or 64x128
+		bool grayscale; // two planes shown alternately, four levels of gray
 	};
 
 	uint8_t contrast;
 
-	const ssd1306_glyph_t* font;
+	const ssd1306_font_t* font;
 
 	ssd1306_connection_t connection;
 } ssd1306_init_s;
 typedef ssd1306_init_s* ssd1306_init_t;
 
+typedef enum {
+	ssd1306_dither_ordered,   // 8x8 Bayer matrix, stable under animation
+	ssd1306_dither_diffusion, // Floyd-Steinberg, finer for photos
+} ssd1306_dither_mode_t;
+
+typedef struct ssd1306_dither_s ssd1306_dither_t;
+
+typedef struct ssd1306_stats_t {
+	uint32_t updates;      // number of transfers to the display
+	uint32_t bytes;        // display data sent
+	uint32_t update_us;    // time spent in transfers, including the transposition
+	uint32_t tiles;        // 8x8 tiles transposed in portrait mode
+	uint32_t transpose_us; // time spent transposing tiles
+	uint32_t cycles;       // grayscale cycles shown, three subframes each
+	uint32_t flicker_hz;   // grayscale cycles per second, measured over the last second
+	uint32_t arena_peak;   // high-water mark of the scratch arena, in bytes
+	uint32_t arena_spills; // scratch allocations that didn't fit and went to the heap
+	uint32_t shift_hits;   // unaligned glyphs and sprites found pre-shifted
+	uint32_t shift_misses; // unaligned glyphs and sprites shifted into the cache
+	uint32_t text_chars;   // characters laid out, after UTF-8 decoding
+	uint32_t text_us;      // time spent formatting and rendering them
+	uint32_t label_hits;   // labels drawn from the label cache
+	uint32_t label_misses; // labels rendered, then kept in the cache when they fit
+} ssd1306_stats_t;
+
+// a horizontal and a vertical alignment, or'ed together
+typedef enum {
+	ssd1306_align_left   = 0x00,
+	ssd1306_align_center = 0x01,
+	ssd1306_align_right  = 0x02,
+	ssd1306_align_top    = 0x00,
+	ssd1306_align_middle = 0x10,
+	ssd1306_align_bottom = 0x20,
+} ssd1306_align_t;
+
+#define SSD1306_LAYOUT_LINES 8 // kept in a layout, further lines are dropped
+
+typedef struct ssd1306_line_t {
+	uint16_t start;  // of the first byte in the text
+	uint16_t length; // in bytes, without the spaces it was broken at
+	uint16_t w;      // in pixels
+} ssd1306_line_t;
+
+// a zero initialised layout is empty, it keeps a copy of the text it was made from
+typedef struct ssd1306_layout_t {
+	char* _Nullable text;
+	uint16_t capacity;
+	uint16_t box_w; // the width the lines were broken at
+
+	union {
+		struct ssd1306_size_t;
+		ssd1306_size_t size; // of all the lines
+	};
+
+	uint8_t lines_z;
+	ssd1306_line_t lines[SSD1306_LAYOUT_LINES];
+} ssd1306_layout_t;
+
+#define SSD1306_FIELD_LENGTH 24 // characters kept by a text field, further ones aren't shown
+
+typedef struct ssd1306_cell_t {
+	uint32_t code; // the code point
+	int16_t x;     // from the left edge of the field
+	uint8_t w;
+	bool invert;
+} ssd1306_cell_t;
+
+// a text field with only its bounds set is drawn in full the first time
+typedef struct ssd1306_field_t {
+	ssd1306_bounds_t bounds;
+	bool drawn; // cleared to draw everything again, as after clearing the display
+	uint16_t w; // of the text shown
+	uint8_t cells_z;
+	ssd1306_cell_t cells[SSD1306_FIELD_LENGTH];
+} ssd1306_field_t;
+
+typedef enum {
+	ssd1306_ticker_left, // the content moves to the left
+	ssd1306_ticker_right,
+	ssd1306_ticker_up,
+	ssd1306_ticker_down,
+} ssd1306_ticker_direction_t;
+
+typedef struct ssd1306_ticker_config_t {
+	uint16_t speed; // in pixels per second
+	uint16_t pause_ms; // before the first step and after each round
+	ssd1306_ticker_direction_t direction;
+} ssd1306_ticker_config_t;
+
+typedef struct ssd1306_ticker_s* ssd1306_ticker_t;
+
+typedef struct ssd1306_tilemap_s* ssd1306_tilemap_t;
+
 typedef struct PACKED ssd1306_s {
 	uint8_t id;
 
 	struct PACKED {
 		bool flip;
+		bool portrait;
+		bool grayscale;
 	};
 
 	union {
@@ -135,7 +303,7 @@ typedef struct PACKED ssd1306_s {
 
 	uint8_t pages;
 
-	const ssd1306_glyph_t* font;
+	const ssd1306_font_t* font;
 } ssd1306_s;
 typedef const ssd1306_s* ssd1306_t;
 
@@ -143,6 +311,10 @@ typedef const ssd1306_s* ssd1306_t;
 
 extern const ssd1306_bitmap_t* splash_bmp;
 
+extern const ssd1306_pattern_t ssd1306_pattern_checker;
+extern const ssd1306_pattern_t ssd1306_pattern_light; // one pixel in four set
+extern const ssd1306_pattern_t ssd1306_pattern_dark;  // one pixel in four clear
+
 // initialisation
 ssd1306_init_t ssd1306_create_init(ssd1306_interface_t type); // returned pointer can be freed after initialisation
 ssd1306_t      ssd1306_init(ssd1306_init_t _Nullable init); // pass NULL to use the default configuration
@@ -171,6 +343,26 @@ void ssd1306_auto_update(ssd1306_t device, bool on);
  */
 void ssd1306_update(ssd1306_t device);
 
+/**
+ * @brief Read the performance counters of the update task.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param stats Receives the counters
+ * @param reset Whether to reset the counters after reading
+ */
+void ssd1306_stats(ssd1306_t device, ssd1306_stats_t* stats, bool reset);
+
+/**
+ * @brief Select the plane all drawing goes into, in grayscale mode.
+ *
+ * Plane 1 is shown twice as long as plane 0, the gray level of a pixel
+ * is 2 * plane 1 + plane 0.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param plane Either 0 or 1
+ */
+void ssd1306_select_plane(ssd1306_t device, uint8_t plane);
+
 /**
  * @brief Acquire exclusive access to the device.
  *
@@ -181,6 +373,9 @@ bool ssd1306_acquire(ssd1306_t device);
 /**
  * @brief Release the exclusive access to the device.
  *
+ * The scratch memory used since the matching acquire is reclaimed,
+ * so calls batched under an outer acquire don't pile it up.
+ *
  * @param device Device handle of the SSD1306 display
  */
 void ssd1306_release(ssd1306_t device);
@@ -188,7 +383,96 @@ void ssd1306_release(ssd1306_t device);
 // lowest level
 uint8_t* ssd1306_raster(ssd1306_t device, uint8_t page);
 ssd1306_bitmap_t* ssd1306_create_bitmap(const ssd1306_size_t size); // returned pointer must be freed after use
+
+/**
+ * @brief Create a bitmap from a row-major image, one bit per pixel.
+ *
+ * @param size The size of the image
+ * @param data The rows of the image
+ * @param stride The distance in bytes between two rows
+ * @param order Which bit of a byte holds its leftmost pixel
+ * @return the bitmap, the pointer must be freed after use
+ */
+ssd1306_bitmap_t* ssd1306_create_bitmap_rows(const ssd1306_size_t size,
+		const uint8_t* data, uint16_t stride, ssd1306_bit_order_t order);
+
+/**
+ * @brief Convert a band of rows of a row-major image into a bitmap.
+ *
+ * Large images can be converted band by band as they are read or decoded,
+ * the bitmap being the only full copy in memory.
+ *
+ * @param bitmap The bitmap receiving the rows
+ * @param y The first row of the band
+ * @param rows The number of rows in the band
+ * @param data The rows of the band
+ * @param stride The distance in bytes between two rows
+ * @param order Which bit of a byte holds its leftmost pixel
+ */
+void ssd1306_bitmap_import(ssd1306_bitmap_t* bitmap, uint16_t y, uint16_t rows,
+		const uint8_t* data, uint16_t stride, ssd1306_bit_order_t order);
+
+ssd1306_bitmap_t* ssd1306_unpack(const ssd1306_packed_t* packed); // returned pointer must be freed after use
+
+ssd1306_dither_t* ssd1306_create_dither(uint16_t width, ssd1306_dither_mode_t mode); // returned pointer must be freed after use
+
+/**
+ * @brief Dither the next band of an 8-bit grayscale image into a bitmap.
+ *
+ * Bands follow each other from the top of the image, the dither only
+ * keeps one line of errors and the page of the last band.
+ *
+ * @param dither The dither state, created for the width of the image
+ * @param bitmap The bitmap receiving the band
+ * @param data The rows of the band, one byte per pixel
+ * @param stride The distance in bytes between two rows
+ * @param rows The number of rows in the band, at most 8
+ */
+void ssd1306_dither_bitmap(ssd1306_dither_t* dither, ssd1306_bitmap_t* bitmap,
+		const uint8_t* data, uint16_t stride, uint8_t rows);
+
+/**
+ * @brief Dither the next band of an 8-bit grayscale image onto the display.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param dither The dither state, created for the width of the image
+ * @param origin Where the top left corner of the image is drawn
+ * @param data The rows of the band, one byte per pixel
+ * @param stride The distance in bytes between two rows
+ * @param rows The number of rows in the band, at most 8
+ */
+void ssd1306_dither_draw(ssd1306_t device, ssd1306_dither_t* dither, ssd1306_point_t origin,
+		const uint8_t* data, uint16_t stride, uint8_t rows);
+
+/**
+ * @brief Make a view over a rectangle of a bitmap, without copying its content.
+ *
+ * @param view The view to be initialised
+ * @param bitmap The bitmap holding the image
+ * @param source An optional rectangle of the bitmap, the whole bitmap if NULL
+ * @return the view, or NULL if the rectangle is outside of the bitmap
+ */
+ssd1306_view_t* ssd1306_view(ssd1306_view_t* view, const ssd1306_bitmap_t* bitmap,
+		const ssd1306_bounds_t* _Nullable source);
+
+/**
+ * @brief Narrow a view to a rectangle relative to its top-left corner.
+ *
+ * @param view The view to be narrowed
+ * @param source The rectangle to keep
+ * @return the view, or NULL if the rectangle is outside of the view
+ */
+ssd1306_view_t* ssd1306_view_crop(ssd1306_view_t* view, const ssd1306_bounds_t* source);
+
 ssd1306_bitmap_t* ssd1306_text_bitmap(ssd1306_t device, const char* format, ...);
+
+/**
+ * @brief Measure a text in the font of the device.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param text The text, characters outside of the font take no room
+ * @return the sum of the advances, the height is the one of the font
+ */
 uint16_t ssd1306_text_width(ssd1306_t device, const char* text);
 
 // geometry
@@ -200,6 +484,7 @@ ssd1306_bounds_t* ssd1306_bounds_move_by(ssd1306_bounds_t* target, const ssd1306
 uint16_t ssd1306_bounds_width(const ssd1306_bounds_t* bounds);
 uint16_t ssd1306_bounds_height(const ssd1306_bounds_t* bounds);
 ssd1306_point_t ssd1306_bounds_center(const ssd1306_bounds_t* bounds);
+ssd1306_size_t ssd1306_transform_size(ssd1306_size_t size, ssd1306_transform_t transform);
 
 // features
 
@@ -212,9 +497,153 @@ ssd1306_point_t ssd1306_bounds_center(const ssd1306_bounds_t* bounds);
 void ssd1306_clear(ssd1306_t device,
 		const ssd1306_bounds_t* _Nullable bounds);
 
+/**
+ * @brief Set or clear all pixels within the provided bounds.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The bounds of the rectangle to be filled, the whole display if NULL
+ * @param value The value of the pixels
+ */
+void ssd1306_fill(ssd1306_t device,
+		const ssd1306_bounds_t* _Nullable bounds, bool value);
+
+/**
+ * @brief Set the gray level of all pixels within the provided bounds, in grayscale mode.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The bounds of the rectangle to be filled, the whole display if NULL
+ * @param level The gray level, from 0 (off) to 3 (fully on)
+ */
+void ssd1306_fill_gray(ssd1306_t device,
+		const ssd1306_bounds_t* _Nullable bounds, uint8_t level);
+
+/**
+ * @brief Invert all pixels within the provided bounds.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The bounds of the rectangle to be inverted, the whole display if NULL
+ */
+void ssd1306_invert_region(ssd1306_t device,
+		const ssd1306_bounds_t* _Nullable bounds);
+
+/**
+ * @brief Fill a rectangle with a repeating 8x8 pattern.
+ *
+ * The pattern is anchored at the display origin, so that adjacent fills line up.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The bounds of the rectangle to be filled, the whole display if NULL
+ * @param pattern The pattern to repeat
+ * @param rop How the pattern is combined with the display content
+ */
+void ssd1306_fill_pattern(ssd1306_t device,
+		const ssd1306_bounds_t* _Nullable bounds,
+		const ssd1306_pattern_t* pattern, ssd1306_rop_t rop);
+
+// primitives, clipped to the display
+
+void ssd1306_pixel(ssd1306_t device, ssd1306_point_t point, ssd1306_color_t color);
+void ssd1306_pixels(ssd1306_t device, const ssd1306_point_t* points, size_t count, ssd1306_color_t color);
+
+/**
+ * @brief Draw a line, both ends included.
+ */
+void ssd1306_line(ssd1306_t device, ssd1306_point_t p0, ssd1306_point_t p1, ssd1306_color_t color);
+
+/**
+ * @brief Draw the outline of a rectangle, or fill it.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The bounds of the rectangle
+ * @param filled Fill the rectangle instead of drawing its outline
+ * @param color How the pixels are changed
+ */
+void ssd1306_rect(ssd1306_t device, const ssd1306_bounds_t* bounds, bool filled, ssd1306_color_t color);
+
+void ssd1306_circle(ssd1306_t device, ssd1306_point_t center, uint16_t r, bool filled, ssd1306_color_t color);
+void ssd1306_ellipse(ssd1306_t device, ssd1306_point_t center, uint16_t rx, uint16_t ry,
+		bool filled, ssd1306_color_t color);
+
+/**
+ * @brief Draw the outline of a closed polygon, or fill it.
+ *
+ * A filled polygon covers the pixels whose centre is inside, with the even-odd rule,
+ * and may have at most 32 vertices.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param points The vertices of the polygon
+ * @param count The number of vertices
+ * @param filled Fill the polygon instead of drawing its outline
+ * @param color How the pixels are changed
+ */
+void ssd1306_polygon(ssd1306_t device, const ssd1306_point_t* points, size_t count,
+		bool filled, ssd1306_color_t color);
+
+/**
+ * @brief Shift the content of a rectangle in place.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The bounds of the rectangle to be shifted, the whole display if NULL
+ * @param dx The horizontal shift, positive to the right
+ * @param dy The vertical shift, positive downwards
+ * @param fill The value of the pixels exposed by the shift
+ */
+void ssd1306_scroll(ssd1306_t device,
+		const ssd1306_bounds_t* _Nullable bounds,
+		int16_t dx, int16_t dy, bool fill);
+
 void ssd1306_draw(ssd1306_t device,
 		const ssd1306_bounds_t* _Nullable target,
 		const ssd1306_bitmap_t* bitmap);
+
+/**
+ * @brief Draw a bitmap combining it with the display content.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target The bounds of the target rectangle to be drawn
+ * @param bitmap The bitmap to be drawn
+ * @param rop The raster operation applied to each pixel
+ */
+void ssd1306_draw_rop(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_bitmap_t* bitmap,
+		ssd1306_rop_t rop);
+
+/**
+ * @brief Draw a bitmap through a mask, pixels outside of the mask are left untouched.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target The bounds of the target rectangle to be drawn
+ * @param bitmap The bitmap to be drawn
+ * @param mask A bitmap of the same size, only pixels set in the mask are drawn
+ * @param rop The raster operation applied to each pixel
+ */
+void ssd1306_draw_masked(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_bitmap_t* bitmap,
+		const ssd1306_bitmap_t* _Nullable mask,
+		ssd1306_rop_t rop);
+
+/**
+ * @brief Register a sprite, whose images shifted for unaligned rows are cached.
+ *
+ * Only bitmaps at most one page high and 16 columns wide qualify, and the
+ * shift cache must be enabled. The bitmap must not change while registered.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bitmap The sprite
+ * @return Whether the sprite has been registered
+ */
+bool ssd1306_register_sprite(ssd1306_t device, const ssd1306_bitmap_t* bitmap);
+
+/**
+ * @brief Unregister a sprite, dropping its cached images.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bitmap The sprite
+ */
+void ssd1306_unregister_sprite(ssd1306_t device, const ssd1306_bitmap_t* bitmap);
+
 /**
  * @brief Draw a bitmap.
  *
@@ -228,6 +657,70 @@ void ssd1306_draw2(ssd1306_t device,
 		const ssd1306_bounds_t* _Nullable target,
 		const ssd1306_bounds_t* _Nullable source);
 
+/**
+ * @brief Draw a view, e.g. a frame of a sprite sheet.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target The bounds of the target rectangle to be drawn
+ * @param view The view to be drawn
+ * @param mask An optional view of the same size, only pixels set in the mask are drawn
+ * @param rop The raster operation applied to each pixel
+ */
+void ssd1306_draw_view(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_view_t* view,
+		const ssd1306_view_t* _Nullable mask,
+		ssd1306_rop_t rop);
+
+/**
+ * @brief Draw a mirrored or rotated view, transforming it while drawing.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target The bounds of the target rectangle to be drawn
+ * @param view The view to be drawn
+ * @param mask An optional view of the same size, transformed along with the view
+ * @param transform The transformation applied to the view
+ * @param rop The raster operation applied to each pixel
+ */
+void ssd1306_draw_transformed(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_view_t* view,
+		const ssd1306_view_t* _Nullable mask,
+		ssd1306_transform_t transform,
+		ssd1306_rop_t rop);
+
+/**
+ * @brief Draw a compressed bitmap, decoding it straight into the display.
+ *
+ * Only the visible part is decoded, one page at a time.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target Where the bitmap is drawn
+ * @param packed The compressed bitmap
+ * @param rop How the bitmap is combined with the display content
+ */
+void ssd1306_draw_packed(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_packed_t* packed,
+		ssd1306_rop_t rop);
+
+/**
+ * @brief Draw a bitmap scaled up, each pixel becoming a square of pixels.
+ *
+ * The bitmap is expanded while drawing, only the visible part of it.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target Where the scaled bitmap is drawn
+ * @param bitmap The bitmap to be drawn
+ * @param scale From 1 to 4
+ * @param rop How the bitmap is combined with the display content
+ */
+void ssd1306_draw_scaled(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_bitmap_t* bitmap,
+		uint8_t scale,
+		ssd1306_rop_t rop);
+
 /**
  * @brief Draw a bitmap at center
  *
@@ -257,8 +750,200 @@ void ssd1306_grab_c(ssd1306_t device, ssd1306_bitmap_t* bitmap);
 
 void ssd1306_text(ssd1306_t device, const ssd1306_bounds_t* target, const char* format, ...);
 
+/**
+ * @brief Draw a text which seldom changes, like a caption or a unit.
+ *
+ * The rendered bitmap is kept in the label cache, keyed by the font, the
+ * formatted text and invert, so drawing the same label again is a copy.
+ * Without a cache, or for labels larger than it, this is ssd1306_text.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target Where the label is drawn, clipped at its edges
+ * @param invert Whether the label starts with the colors inverted
+ * @param format The text, formatted as in ssd1306_text
+ */
+void ssd1306_label(ssd1306_t device, const ssd1306_bounds_t* target, bool invert, const char* format, ...);
+
+/**
+ * @brief Draw a text with the font of the device scaled up.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target Where the text is drawn, clipped at its edges
+ * @param scale From 1 to 4
+ * @param format The text, formatted as in ssd1306_text
+ */
+void ssd1306_text_scaled(ssd1306_t device, const ssd1306_bounds_t* target, uint8_t scale,
+		const char* format, ...);
+
+/**
+ * @brief Format a text and break it into lines on word boundaries.
+ *
+ * Lines are broken at spaces and new lines, a word wider than the box
+ * is broken anywhere. Nothing is measured again when the text and the
+ * width are those of the previous call, so a layout can be refreshed
+ * every frame.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param layout The layout to be updated
+ * @param width The width of the box the text is laid out in
+ * @param format The text, formatted as in ssd1306_text
+ * @return true when the layout changed
+ */
+bool ssd1306_layout(ssd1306_t device, ssd1306_layout_t* layout, uint16_t width, const char* format, ...);
+
+/**
+ * @brief Release the text kept by a layout, which is then empty.
+ *
+ * @param layout The layout to be released
+ */
+void ssd1306_layout_free(ssd1306_layout_t* layout);
+
+/**
+ * @brief Draw a layout into a box, cleared first and updated as a whole.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target The box, lines are clipped at its edges
+ * @param layout The layout to be drawn
+ * @param align Where the lines go within the box
+ */
+void ssd1306_draw_layout(ssd1306_t device, const ssd1306_bounds_t* target,
+		const ssd1306_layout_t* layout, ssd1306_align_t align);
+
+/**
+ * @brief Update a text field, redrawing only the glyphs which changed.
+ *
+ * The glyphs of the previous text are remembered with their positions,
+ * those found again at the same spot aren't drawn. With
+ * CONFIG_SSD1306_OPTIMIZE only the columns of the others are sent to the
+ * display, otherwise the whole frame is. A glyph of a different width
+ * moves the rest of the text, which is then redrawn.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param field The field, its bounds set by the caller
+ * @param format The text, formatted as in ssd1306_text
+ */
+void ssd1306_field(ssd1306_t device, ssd1306_field_t* field, const char* format, ...);
+
+/**
+ * @brief Create a grid of 8x8 tiles shown in a page-aligned region.
+ *
+ * The grid is composited into the raster by the update task, changed
+ * cells only, each of them 8 bytes of one page. All the cells start with
+ * tile 0. The map wraps around when scrolled or smaller than the region.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The region, its top on a page boundary
+ * @param cols Columns of the grid
+ * @param rows Rows of the grid
+ * @param atlas The tiles, 8 bytes each, a byte a column with bit 0 at the top
+ * @param tiles How many tiles there are in the atlas
+ * @return the tile map, to be freed with ssd1306_free_tilemap
+ */
+ssd1306_tilemap_t ssd1306_create_tilemap(ssd1306_t device, const ssd1306_bounds_t* bounds,
+		uint8_t cols, uint8_t rows, const uint8_t* atlas, uint16_t tiles);
+
+/**
+ * @brief Stop showing a tile map and free it, what it shows is left on the display.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param map The tile map, NULL is ignored
+ */
+void ssd1306_free_tilemap(ssd1306_t device, ssd1306_tilemap_t _Nullable map);
+
+/**
+ * @brief Put a tile in a cell of the grid.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param map The tile map
+ * @param col The column of the cell
+ * @param row The row of the cell
+ * @param tile The index of the tile in the atlas
+ */
+void ssd1306_tilemap_set(ssd1306_t device, ssd1306_tilemap_t map, uint8_t col, uint8_t row, uint8_t tile);
+
+/**
+ * @brief Scroll the region over the map, by pixels.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param map The tile map
+ * @param x Where the left of the region is in the map
+ * @param y Where the top of the region is in the map
+ */
+void ssd1306_tilemap_scroll(ssd1306_t device, ssd1306_tilemap_t map, int16_t x, int16_t y);
+
+/**
+ * @brief Lay out and draw a text in one go, with nothing kept.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param target The box the text is laid out in
+ * @param align Where the lines go within the box
+ * @param format The text, formatted as in ssd1306_text
+ */
+void ssd1306_text_box(ssd1306_t device, const ssd1306_bounds_t* target, ssd1306_align_t align,
+		const char* format, ...);
+
+/**
+ * @brief Show a text in a status line, scrolling when wider than the display.
+ *
+ * Nothing is done when the formatted text is the one already shown. A new
+ * text of the same width as a scrolling one takes its place where the scroll
+ * is. The status is drawn anew after it was cleared, not after drawing over
+ * it otherwise.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param status The status line
+ * @param format The text, formatted as in ssd1306_text, NULL to blank the line
+ */
 void ssd1306_status(ssd1306_t device, ssd1306_status_t status,
 		const char* format, ...);
+
+/**
+ * @brief Create a region where content larger than it scrolls round.
+ *
+ * Content that fits in the region stays still. Any number of tickers may
+ * run, all of them stepped by the update task, the status lines among them.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param bounds The region, in which the content is drawn from the top-left corner
+ * @param config How the content moves
+ * @return the ticker, to be freed with ssd1306_free_ticker
+ */
+ssd1306_ticker_t ssd1306_create_ticker(ssd1306_t device, const ssd1306_bounds_t* bounds,
+		const ssd1306_ticker_config_t* config);
+
+/**
+ * @brief Stop a ticker and free it, what it shows is left on the display.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param ticker The ticker, NULL is ignored
+ */
+void ssd1306_free_ticker(ssd1306_t device, ssd1306_ticker_t _Nullable ticker);
+
+/**
+ * @brief Set the content of a ticker, a copy of the bitmap is kept.
+ *
+ * Content of the same size as the one scrolling takes its place without
+ * restarting the scroll.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param ticker The ticker
+ * @param bitmap The new content
+ */
+void ssd1306_ticker_bitmap(ssd1306_t device, ssd1306_ticker_t ticker, const ssd1306_bitmap_t* bitmap);
+
+/**
+ * @brief Set the content of a ticker to a text, as ssd1306_ticker_bitmap.
+ *
+ * A text wider than a horizontal ticker gets the status separator, to tell
+ * its end from its start. For a vertical ticker the text is broken into lines
+ * as wide as the ticker, as in ssd1306_text_box, and a blank line follows the
+ * last one when they don't all fit.
+ *
+ * @param device Device handle of the SSD1306 display
+ * @param ticker The ticker
+ * @param format The text, formatted as in ssd1306_text
+ */
+void ssd1306_ticker_text(ssd1306_t device, ssd1306_ticker_t ticker, const char* format, ...);
 const ssd1306_bounds_t* ssd1306_status_bounds(ssd1306_t device, ssd1306_status_t status,
 		ssd1306_bounds_t* _Nullable target);
 
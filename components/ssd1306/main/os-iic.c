@@ -15,12 +15,18 @@ static const ssd1306_init_s init_default = {
 #if CONFIG_SSD1306_FLIP
 	flip: true,
 #endif
+#if CONFIG_SSD1306_PORTRAIT
+	portrait: true,
+#endif
+#if CONFIG_SSD1306_GRAYSCALE
+	grayscale: true,
+#endif
 #if CONFIG_SSD1306_INVERT
 	invert: true,
 #endif
 	contrast: CONFIG_SSD1306_CONTRAST,
 
-	font: ssd1306_default_font,
+	font: &ssd1306_default_font,
 
 	connection: {
 		type: ssd1306_interface_iic,
@@ -25,7 +25,7 @@ typedef struct ssd1306_int_s* ssd1306_int_t;
 typedef struct ssd1306_iic_s* ssd1306_iic_t;
 typedef struct ssd1306_spi_s* ssd1306_spi_t;
 
-extern const ssd1306_glyph_t ssd1306_default_font[] asm("_binary_" CONFIG_SSD1306_FONT_NAME "_fnt_start");
+extern const ssd1306_font_t ssd1306_default_font asm("_binary_" CONFIG_SSD1306_FONT_NAME "_fnt_start");
 
 ssd1306_init_t ssd1306_iic_create_init();
 ssd1306_init_t ssd1306_spi_create_init();
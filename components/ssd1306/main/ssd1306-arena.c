@@ -0,0 +1,66 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+#define ARENA_ALIGN sizeof(uint32_t)
+
+/*
+	Bump allocator for the memory a call needs only until it returns. It
+	must be used with the device acquired, each release rewinds it to where
+	the matching acquire found it.
+*/
+void* ssd1306_arena_alloc(ssd1306_int_t dev, size_t size)
+{
+	arena_info_t* const arena = &dev->arena;
+
+	ABORT_IF(arena->depth == 0, "the scratch arena needs the device to be acquired");
+
+	const size_t length = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+	if( length > arena->size - arena->used ) {
+		void* ptr = malloc(size);
+
+		ABORT_IF(ptr == NULL, "cannot allocate %u bytes of scratch memory", size);
+
+		LOG_W("scratch arena exhausted, %u bytes taken from the heap", size);
+
+		dev->stats.arena_spills++;
+
+		return ptr;
+	}
+
+	void* ptr = arena->base + arena->used;
+
+	arena->used += length;
+
+	if( dev->stats.arena_peak < arena->used ) {
+		dev->stats.arena_peak = arena->used;
+	}
+
+	LOG_T("allocated %u scratch bytes at %p, %u used", size, ptr, arena->used);
+
+	return ptr;
+}
+
+void ssd1306_arena_free(ssd1306_int_t dev, void* ptr)
+{
+	const arena_info_t* const arena = &dev->arena;
+
+	// the arena is reclaimed as a whole, only what spilled over is freed
+	if( (uint8_t*)ptr < arena->base || (uint8_t*)ptr >= arena->base + arena->size ) {
+		free(ptr);
+	}
+}
+
+ssd1306_bitmap_t* ssd1306_arena_bitmap(ssd1306_int_t dev, ssd1306_size_t size)
+{
+	const size_t length = sizeof(ssd1306_bitmap_t) + bytes_cap(size.h) * size.w;
+
+	ssd1306_bitmap_t* bitmap = ssd1306_arena_alloc(dev, length);
+
+	memset(bitmap, 0, length);
+	memcpy((void*)&bitmap->size, &size, sizeof(bitmap->size));
+
+	return bitmap;
+}
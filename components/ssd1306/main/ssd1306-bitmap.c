@@ -18,6 +18,42 @@ ssd1306_bitmap_t* ssd1306_create_bitmap(const ssd1306_size_t size)
 	return bitmap;
 }
 
+ssd1306_view_t* ssd1306_view(ssd1306_view_t* view, const ssd1306_bitmap_t* bitmap, const ssd1306_bounds_t* source)
+{
+	ABORT_IF_NULL(view);
+	ABORT_IF_NULL(bitmap);
+
+	view->size = bitmap->size;
+	view->stride = bitmap->w;
+	view->shift = 0;
+	view->image = bitmap->image;
+
+	return source ? ssd1306_view_crop(view, source) : view;
+}
+
+ssd1306_view_t* ssd1306_view_crop(ssd1306_view_t* view, const ssd1306_bounds_t* source)
+{
+	ABORT_IF_NULL(view);
+	ABORT_IF_NULL(source);
+
+	ssd1306_bounds_t bounds = { x1: view->w, y1: view->h };
+
+	if( !ssd1306_bounds_intersect(&bounds, source) ) {
+		LOG_BOUNDS_D("non visible source", source);
+
+		return NULL;
+	}
+
+	const uint16_t row = view->shift + bounds.y0;
+
+	view->w = ssd1306_bounds_width(&bounds);
+	view->h = ssd1306_bounds_height(&bounds);
+	view->shift = row & 7;
+	view->image += (row >> 3) * view->stride + bounds.x0;
+
+	return view;
+}
+
 void ssd1306_center_bounds(ssd1306_t device, ssd1306_bounds_t* bounds, const ssd1306_bitmap_t* bitmap)
 {
 	bounds->x0 = ((int)device->w - (int)bitmap->w) / 2;
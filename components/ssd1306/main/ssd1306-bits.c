@@ -0,0 +1,45 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+#define R2(n) (n), (n) + 2*64, (n) + 1*64, (n) + 3*64
+#define R4(n) R2(n), R2((n) + 2*16), R2((n) + 1*16), R2((n) + 3*16)
+#define R6(n) R4(n), R4((n) + 2*4), R4((n) + 1*4), R4((n) + 3*4)
+
+// bit 0 swapped with bit 7, bit 1 with bit 6, and so on
+const uint8_t ssd1306_reverse_bits[256] = {
+	R6(0), R6(2), R6(1), R6(3)
+};
+
+#undef R6
+#undef R4
+#undef R2
+
+/*
+	Transpose a block of 8x8 pixels: bit i of source byte j becomes
+	bit j of target byte i. Both blocks are made of 8 bytes read and
+	written with the given stride, so a page-major tile turns into
+	eight row-major bytes (LSB first) and the other way around.
+*/
+void ssd1306_transpose8(const uint8_t* source, size_t s_stride, uint8_t* target, size_t t_stride)
+{
+	uint64_t x = 0;
+
+	for( unsigned k = 0; k < 8; k++ ) {
+		x |= (uint64_t)source[k * s_stride] << (8 * k);
+	}
+
+	uint64_t t;
+
+	t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+	x = x ^ t ^ (t << 28);
+
+	for( unsigned k = 0; k < 8; k++ ) {
+		target[k * t_stride] = x >> (8 * k);
+	}
+}
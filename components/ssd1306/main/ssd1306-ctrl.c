@@ -81,6 +81,8 @@ void ssd1306_update(ssd1306_t device)
 		free(dev->dirty_bounds);
 
 		dev->dirty_bounds = NULL;
+	} else if( dev->tilemaps ) {
+		ssd1306_wake_internal(dev);
 	} else {
 		LOG_D("no dirty bounds");
 	}
@@ -89,6 +91,22 @@ void ssd1306_update(ssd1306_t device)
 #endif
 }
 
+/*
+	Wakes the task up for what it draws itself, with nothing else to
+	send. Deferred updates are left to ssd1306_update. A full queue
+	already wakes the task, which never blocks here with the device held.
+*/
+void ssd1306_wake_internal(ssd1306_int_t dev)
+{
+#if CONFIG_SSD1306_OPTIMIZE
+	static const ssd1306_bounds_t none = { };
+
+	xQueueSend(dev->queue, &none, 0);
+#else
+	xTaskNotifyGive(dev->task);
+#endif
+}
+
 void ssd1306_update_internal(ssd1306_t device, const ssd1306_bounds_t* bounds)
 {
 	ABORT_IF_NULL(device);
@@ -119,13 +137,61 @@ void ssd1306_update_internal(ssd1306_t device, const ssd1306_bounds_t* bounds)
 #endif
 }
 
+void ssd1306_select_plane(ssd1306_t device, uint8_t plane)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF(plane > 1, "invalid plane %u", plane);
+	ABORT_IF(plane > 0 && !device->grayscale, "plane %u needs grayscale mode", plane);
+
+	ssd1306_int_t const dev = (ssd1306_int_t)device;
+
+	if( ssd1306_acquire(device) ) {
+		dev->raster = dev->planes[plane];
+
+		ssd1306_release(device);
+	} else {
+		LOG_W("Couldn't take mutex");
+	}
+}
+
+void ssd1306_stats(ssd1306_t device, ssd1306_stats_t* stats, bool reset)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(stats);
+
+	ssd1306_int_t const dev = (ssd1306_int_t)device;
+
+	if( ssd1306_acquire(device) ) {
+		*stats = dev->stats;
+
+		if( reset ) {
+			memset(&dev->stats, 0, sizeof(dev->stats));
+		}
+
+		ssd1306_release(device);
+	} else {
+		LOG_W("Couldn't take mutex");
+	}
+}
+
 bool ssd1306_acquire(ssd1306_t device)
 {
 	ABORT_IF_NULL(device);
 
 	ssd1306_int_t const dev = (ssd1306_int_t)device;
 
-	return xSemaphoreTakeRecursive(dev->mutex, portMAX_DELAY);
+	if( !xSemaphoreTakeRecursive(dev->mutex, portMAX_DELAY) ) {
+		return false;
+	}
+
+	// where this call's scratch memory starts, the matching release rewinds to it
+	if( dev->arena.depth < SSD1306_ARENA_DEPTH ) {
+		dev->arena.marks[dev->arena.depth] = dev->arena.used;
+	}
+
+	dev->arena.depth++;
+
+	return true;
 }
 
 void ssd1306_release(ssd1306_t device)
@@ -134,5 +200,10 @@ void ssd1306_release(ssd1306_t device)
 
 	ssd1306_int_t const dev = (ssd1306_int_t)device;
 
+	// the call ends, its scratch memory goes with it
+	if( --dev->arena.depth < SSD1306_ARENA_DEPTH ) {
+		dev->arena.used = dev->arena.marks[dev->arena.depth];
+	}
+
 	xSemaphoreGiveRecursive(dev->mutex);
 }
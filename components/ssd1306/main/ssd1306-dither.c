@@ -0,0 +1,180 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+struct ssd1306_dither_s {
+	ssd1306_dither_mode_t mode;
+	uint16_t w;
+	uint16_t y; // the next row to be dithered
+	uint8_t* page; // the last band, page-major
+	int16_t line[]; // the errors carried to the next row
+};
+
+// 8x8 Bayer matrix
+static const uint8_t BAYER[8][8] = {
+	{  0, 32,  8, 40,  2, 34, 10, 42 },
+	{ 48, 16, 56, 24, 50, 18, 58, 26 },
+	{ 12, 44,  4, 36, 14, 46,  6, 38 },
+	{ 60, 28, 52, 20, 62, 30, 54, 22 },
+	{  3, 35, 11, 43,  1, 33,  9, 41 },
+	{ 51, 19, 59, 27, 49, 17, 57, 25 },
+	{ 15, 47,  7, 39, 13, 45,  5, 37 },
+	{ 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+static void dither_band(ssd1306_dither_t* dither, const uint8_t* data, uint16_t stride, uint8_t rows);
+static void dither_ordered(ssd1306_dither_t* dither, const uint8_t* row, uint8_t bit);
+static void dither_diffusion(ssd1306_dither_t* dither, const uint8_t* row, uint8_t bit);
+
+ssd1306_dither_t* ssd1306_create_dither(uint16_t width, ssd1306_dither_mode_t mode)
+{
+	ABORT_IF(mode > ssd1306_dither_diffusion, "invalid dither mode %d", mode);
+	ABORT_IF(width == 0, "cannot dither an empty image");
+
+	const size_t length = sizeof(ssd1306_dither_t) + width * sizeof(int16_t) + width;
+
+	ssd1306_dither_t* dither = calloc(1, length);
+
+	ABORT_IF(dither == NULL, "cannot allocate memory for dither of width %u", width);
+
+	LOG_D("allocated dither of width %u, %u bytes at %p", width, length, dither);
+
+	dither->mode = mode;
+	dither->w = width;
+	dither->page = (uint8_t*)(dither->line + width);
+
+	return dither;
+}
+
+void ssd1306_dither_bitmap(ssd1306_dither_t* dither, ssd1306_bitmap_t* bitmap,
+	const uint8_t* data, uint16_t stride, uint8_t rows)
+{
+	ABORT_IF_NULL(dither);
+	ABORT_IF_NULL(bitmap);
+
+	const uint16_t y = dither->y;
+
+	dither_band(dither, data, stride, rows);
+
+	if( y >= bitmap->h ) {
+		return;
+	}
+
+	rows = minu(rows, bitmap->h - y);
+
+	const uint16_t width = minu(dither->w, bitmap->w);
+	const uint16_t page = y / 8;
+	const uint8_t bits = y % 8;
+
+	uint8_t* target = bitmap->image + page * bitmap->w;
+
+	// the band lands on one page, or straddles two when not aligned
+	const uint8_t t_mask = page_mask(bits, minu(bits + rows, 8));
+
+	for( uint16_t x = 0; x < width; x++ ) {
+		target[x] = (target[x] & ~t_mask) | ((dither->page[x] << bits) & t_mask);
+	}
+
+	if( bits + rows > 8 ) {
+		const uint8_t b_mask = page_mask(0, bits + rows - 8);
+
+		target += bitmap->w;
+
+		for( uint16_t x = 0; x < width; x++ ) {
+			target[x] = (target[x] & ~b_mask) | ((dither->page[x] >> (8 - bits)) & b_mask);
+		}
+	}
+}
+
+void ssd1306_dither_draw(ssd1306_t device, ssd1306_dither_t* dither, ssd1306_point_t origin,
+	const uint8_t* data, uint16_t stride, uint8_t rows)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(dither);
+
+	const int16_t y = origin.y + dither->y;
+
+	dither_band(dither, data, stride, rows);
+
+	const ssd1306_view_t view = {
+		w: dither->w, h: rows,
+		stride: dither->w,
+		image: dither->page,
+	};
+	const ssd1306_bounds_t target = {
+		x0: origin.x, y0: y,
+		x1: origin.x + dither->w, y1: y + rows,
+	};
+
+	ssd1306_draw_view(device, &target, &view, NULL, ssd1306_rop_copy);
+}
+
+/*
+	Dithers up to 8 rows into the page, row r of the band landing on bit r.
+*/
+void dither_band(ssd1306_dither_t* dither, const uint8_t* data, uint16_t stride, uint8_t rows)
+{
+	ABORT_IF_NULL(data);
+	ABORT_IF(rows > 8, "a band has at most 8 rows, not %u", rows);
+	ABORT_IF(stride < dither->w, "stride %u too small for width %u", stride, dither->w);
+
+	memset(dither->page, 0, dither->w);
+
+	for( uint8_t r = 0; r < rows; r++, dither->y++ ) {
+		if( dither->mode == ssd1306_dither_ordered ) {
+			dither_ordered(dither, data + r * stride, r);
+		} else {
+			dither_diffusion(dither, data + r * stride, r);
+		}
+	}
+}
+
+void dither_ordered(ssd1306_dither_t* dither, const uint8_t* row, uint8_t bit)
+{
+	const uint8_t* thresholds = BAYER[dither->y & 7];
+	const uint8_t mask = 1 << bit;
+
+	for( uint16_t x = 0; x < dither->w; x++ ) {
+		// levels 0 and 255 stay solid, the thresholds are spread between
+		if( row[x] > thresholds[x & 7] * 4 + 2 ) {
+			dither->page[x] |= mask;
+		}
+	}
+}
+
+/*
+	Floyd-Steinberg with a single error line: line[x] holds the error
+	carried to pixel x of the current row, and is replaced by the one for
+	pixel x - 1 of the next row once that is final. The errors for the
+	next row at x - 1 and x are kept pending in two variables.
+*/
+void dither_diffusion(ssd1306_dither_t* dither, const uint8_t* row, uint8_t bit)
+{
+	int16_t* const line = dither->line;
+	const uint8_t mask = 1 << bit;
+
+	int16_t right = 0;
+	int16_t below_left = 0;
+	int16_t below = 0;
+
+	for( uint16_t x = 0; x < dither->w; x++ ) {
+		const int16_t value = row[x] + line[x] + right;
+		int16_t error = value;
+
+		if( value > 127 ) {
+			dither->page[x] |= mask;
+			error -= 255;
+		}
+
+		if( x > 0 ) {
+			line[x - 1] = below_left + error * 3 / 16;
+		}
+
+		below_left = below + error * 5 / 16;
+		below = error / 16;
+		right = error * 7 / 16;
+	}
+
+	line[dither->w - 1] = below_left;
+}
@@ -3,10 +3,8 @@
 
 #include "ssd1306-int.h"
 
-static void ssd1306_draw_page_1(ssd1306_t device, 
-	uint8_t page, int16_t offset, uint16_t width, const uint8_t* data, int8_t bits);
-static void ssd1306_draw_page_2(ssd1306_t device,
-	uint8_t page, int16_t offset, uint16_t width, const uint8_t* data, int8_t bits, uint8_t d_mask);
+// source rows falling outside of the bitmap are read from here
+static const uint8_t ZERO_PAGE[CONFIG_SSD1306_WIDTH] = {};
 
 static inline bool adjust_source_bounds(ssd1306_bounds_t* target,
 	const ssd1306_bitmap_t* bitmap,
@@ -28,23 +26,13 @@ static inline bool adjust_source_bounds(ssd1306_bounds_t* target,
 	return true;
 }
 
-static inline bool adjust_both_bounds(ssd1306_bounds_t* target, ssd1306_bounds_t* source)
+static inline const uint8_t* view_page(const ssd1306_view_t* view, int16_t page, uint16_t offset)
 {
-	ssd1306_bounds_t s_temp = *source;
-
-	ssd1306_bounds_move_to(&s_temp, target->head);
-
-	if( ssd1306_bounds_intersect(target, &s_temp) ) {
-		LOG_BOUNDS_T("target", target);
-		LOG_BOUNDS_T("source", source);
-	} else {
-		LOG_BOUNDS_W("weird case, target", target);
-		LOG_BOUNDS_W("            source", source);
-
-		return false;
+	if( page < 0 || page >= (int16_t)bytes_cap(view->shift + view->h) ) {
+		return ZERO_PAGE;
 	}
 
-	return true;
+	return view->image + page * view->stride + offset;
 }
 
 void ssd1306_draw2(ssd1306_t device, const ssd1306_bitmap_t* bitmap,
@@ -54,63 +42,86 @@ void ssd1306_draw2(ssd1306_t device, const ssd1306_bitmap_t* bitmap,
 	ABORT_IF_NULL(bitmap);
 
 	ssd1306_bounds_t s_bounds;
-	ssd1306_bounds_t d_bounds;
+	ssd1306_view_t view;
 
 	if( !adjust_source_bounds(&s_bounds, bitmap, source) ) {
 		return;
 	}
-	if( !ssd1306_adjust_target_bounds(&d_bounds, device, target) ) {
+
+	ssd1306_view(&view, bitmap, &s_bounds);
+
+	// the part of the source cut by the bitmap edges moves the origin
+	ssd1306_bounds_t bounds = target ? *target : device->bounds;
+	ssd1306_bounds_t trimmed = bounds;
+
+	if( source ) {
+		ssd1306_bounds_move_by(&bounds, (ssd1306_point_t){
+			s_bounds.x0 - source->x0, s_bounds.y0 - source->y0 });
+	}
+
+	ssd1306_bounds_resize(&bounds, view.size);
+
+	if( !ssd1306_bounds_intersect(&trimmed, &bounds) || !ssd1306_trim(device, &trimmed, NULL) ) {
 		return;
 	}
-	if( !adjust_both_bounds(&d_bounds, &s_bounds) ) {
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
 		return;
 	}
 
+	ssd1306_draw_view_internal(device, &bounds, &trimmed, &view, NULL, ssd1306_rop_copy);
+	ssd1306_update_internal(device, &trimmed);
+
+	ssd1306_release(device);
+}
+
+void ssd1306_draw_view(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_view_t* view, const ssd1306_view_t* mask, ssd1306_rop_t rop)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(view);
+	ABORT_IF(mask && (mask->w != view->w || mask->h != view->h),
+		"mask of %ux%u doesn't match view of %ux%u", mask->w, mask->h, view->w, view->h);
+
+	ssd1306_bounds_t trimmed = *target;
+
+	if( !ssd1306_trim(device, &trimmed, &view->size) ) {
+		return;
+	}
 	if( !ssd1306_acquire(device) ) {
 		LOG_W("Couldn't take mutex");
 
 		return;
 	}
 
-	/*
-		device: [0, 16)
-			target: [3, 15)
-				 image: [0, 14)
-				source: [5, 13)
-
-				+
-				|
-		+		|
-		|		|
-		|		|
-		|	+	-
-		|	|	|
-		|	|	|
-		|	|	+
-		|	|	|
-		+	|	|
-		|	|	|
-		|	|	-
-		|	+	|
-		|	|	|
-		|	|
-		|	|
-		|
-		+
-	
-	*/
-
-	ssd1306_update_internal(device, &d_bounds);
+	ssd1306_draw_view_internal(device, target, &trimmed, view, mask, rop);
+	ssd1306_update_internal(device, &trimmed);
 
 	ssd1306_release(device);
 }
 
 void ssd1306_draw(ssd1306_t device, const ssd1306_bounds_t* target,
 	const ssd1306_bitmap_t* bitmap)
+{
+	ssd1306_draw_rop(device, target, bitmap, ssd1306_rop_copy);
+}
+
+void ssd1306_draw_rop(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_bitmap_t* bitmap, ssd1306_rop_t rop)
+{
+	ssd1306_draw_masked(device, target, bitmap, NULL, rop);
+}
+
+void ssd1306_draw_masked(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_bitmap_t* bitmap, const ssd1306_bitmap_t* mask, ssd1306_rop_t rop)
 {
 	ABORT_IF_NULL(device);
 	ABORT_IF_NULL(target);
 	ABORT_IF_NULL(bitmap);
+	ABORT_IF(mask && (mask->w != bitmap->w || mask->h != bitmap->h),
+		"mask of %ux%u doesn't match bitmap of %ux%u", mask->w, mask->h, bitmap->w, bitmap->h);
 
 	ssd1306_bounds_t trimmed = *target;
 
@@ -123,7 +134,7 @@ void ssd1306_draw(ssd1306_t device, const ssd1306_bounds_t* target,
 		return;
 	}
 
-	ssd1306_draw_internal(device, target, &trimmed, bitmap);
+	ssd1306_draw_internal(device, target, &trimmed, bitmap, mask, rop);
 	ssd1306_update_internal(device, &trimmed);
 
 	ssd1306_release(device);
@@ -134,94 +145,134 @@ void ssd1306_draw_c(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
 	ABORT_IF_NULL(device);
 	ABORT_IF_NULL(bitmap);
 
+	ssd1306_bounds_t bounds;
+	ssd1306_center_bounds(device, &bounds, bitmap);
+
+	ssd1306_bounds_t trimmed = bounds;
+
+	if( !ssd1306_trim(device, &trimmed, NULL) ) {
+		return;
+	}
 	if( !ssd1306_acquire(device) ) {
 		LOG_W("Couldn't take mutex");
 
 		return;
 	}
 
-	ssd1306_bounds_t bounds;
-	ssd1306_center_bounds(device, &bounds, bitmap);
-
-	ssd1306_draw_internal(device, &bounds, &bounds, bitmap);
-	ssd1306_update_internal(device, &bounds);
+	ssd1306_draw_internal(device, &bounds, &trimmed, bitmap, NULL, ssd1306_rop_copy);
+	ssd1306_update_internal(device, &trimmed);
 
 	ssd1306_release(device);
 }
 
 void ssd1306_draw_internal(ssd1306_t device,
 	const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
-	const ssd1306_bitmap_t* bitmap)
+	const ssd1306_bitmap_t* bitmap, const ssd1306_bitmap_t* mask, ssd1306_rop_t rop)
 {
-	const uint8_t* image = bitmap->image;
-
-	if( bounds->x0 < 0 ) {
-		image += -bounds->x0;
+	if( !mask && ssd1306_shift_draw(device, bounds, trimmed, bitmap, rop) ) {
+		return;
 	}
 
-	int16_t y_bits = 0;
+	ssd1306_view_t s_view;
+	ssd1306_view_t m_view;
 
-	if( bounds->y0 < 0 ) {
-		y_bits = bounds->y0 & 7;
+	ssd1306_view(&s_view, bitmap, NULL);
 
-		image += ((-bounds->y0-1) / 8) * bitmap->w;
-
-		LOG_D("Image shifted by %d for y_bits %d", image - bitmap->image, y_bits);
+	if( mask ) {
+		ssd1306_view(&m_view, mask, NULL);
 	}
 
+	ssd1306_draw_view_internal(device, bounds, trimmed, &s_view, mask ? &m_view : NULL, rop);
+}
+
+/*
+	The view is laid out with its top-left corner at bounds->head, while
+	only the trimmed rectangle is written. Each raster page collects its
+	8 rows from at most two consecutive pages of the view, so the same
+	kernel serves aligned and unaligned positions alike.
+*/
+void ssd1306_draw_view_internal(ssd1306_t device,
+	const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
+	const ssd1306_view_t* view, const ssd1306_view_t* mask, ssd1306_rop_t rop)
+{
+	const uint16_t s_offset = trimmed->x0 - bounds->x0;
 	const uint16_t trimmed_w = ssd1306_bounds_width(trimmed);
 
-	const int16_t t_page = bounds->y0 < 0 ? -1 : trimmed->y0 >> 3;
-	const int16_t t_bits = bounds->y0 < 0 ? y_bits : trimmed->y0 & 7;
+	const int16_t t_page = trimmed->y0 >> 3;
+	const int16_t b_page = (trimmed->y1 - 1) >> 3;
 
-	const int16_t b_page = trimmed->y1 >> 3;
-	const int16_t b_bits = trimmed->y1 & 7;
+	LOG_D("t_page = %d, b_page = %d, rop = %d", t_page, b_page, rop);
 
-	LOG_D("t_page = %d, t_bits = %d", t_page, t_bits);
-	LOG_D("b_page = %d, b_bits = %d", b_page, b_bits);
+	for( int16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t y = page * SSD1306_PAGE_HEIGHT;
 
-	for( int16_t page = t_page; page < b_page; image += bitmap->w ) {
-		if( page >= 0 ) {
-			ssd1306_draw_page_1(device, page, trimmed->x0, trimmed_w, image, -t_bits);
-		}
+		// the source row landing on bit 0 of this page, might be negative
+		const int16_t row = y - bounds->y0 + view->shift;
+		const int16_t s_page = row >> 3;
+		const uint8_t s_bits = row & 7;
 
-		page++;
+		const uint8_t d_mask = page_mask(
+			trimmed->y0 > y ? trimmed->y0 - y : 0,
+			trimmed->y1 < y + 8 ? trimmed->y1 - y : 8);
 
-		if( t_bits && (page < b_page) ) {
-			ssd1306_draw_page_1(device, page, trimmed->x0, trimmed_w, image, 8-t_bits);
-		}
-		if( b_bits && (page == b_page) ) {
-			ssd1306_draw_page_1(device, page, trimmed->x0, trimmed_w, image, b_bits);
+		const uint8_t* m_lo = NULL;
+		const uint8_t* m_hi = NULL;
+		uint8_t m_bits = 0;
+
+		if( mask ) {
+			const int16_t m_row = y - bounds->y0 + mask->shift;
+
+			m_lo = view_page(mask, m_row >> 3, s_offset);
+			m_hi = view_page(mask, (m_row >> 3) + 1, s_offset);
+			m_bits = m_row & 7;
 		}
+
+		ssd1306_draw_page(ssd1306_raster(device, page) + trimmed->x0, trimmed_w,
+			view_page(view, s_page, s_offset), view_page(view, s_page + 1, s_offset), s_bits,
+			m_lo, m_hi, m_bits, d_mask, rop);
 	}
 }
 
-void ssd1306_draw_page_1(ssd1306_t device, uint8_t page, int16_t offset, uint16_t width, const uint8_t* data, int8_t s_bits)
+static inline uint8_t fetch_bits(const uint8_t* lo, const uint8_t* hi, uint8_t bits, unsigned x)
 {
-	LOG_T("page %d with s_bits = %+d", page, s_bits);
-
-	ssd1306_draw_page_2(device, page, offset, width, data, s_bits, set_bits(s_bits));
+	return (uint8_t)(lo[x] >> bits) | (uint8_t)(hi[x] << (8 - bits));
 }
 
-void ssd1306_draw_page_2(ssd1306_t device, uint8_t page, int16_t offset, uint16_t width, const uint8_t* data, int8_t s_bits, uint8_t d_mask)
-{
-	uint8_t* buff = ssd1306_raster(device, page) + offset;
-
-	if( d_mask == 0xff && s_bits == 0 ) {
-		LOG_T("page %d from %p", page, data);
-
-		memcpy(buff, data, width);
-	} else {
-		const uint8_t s_mask = ~d_mask;
-
-		LOG_T("page %d with d_mask 0x%02x, s_bits = %+d, s_mask = 0x%02x, from %p", page, d_mask, s_bits, s_mask, data);
+#define DRAW_LOOP(m_expr, r_expr) \
+	for( unsigned x = 0; x < width; x++ ) { \
+		const uint8_t s = fetch_bits(s_lo, s_hi, s_bits, x); \
+		const uint8_t m = (m_expr); \
+		buff[x] = (buff[x] & ~m) | ((r_expr) & m); \
+	}
 
-		ssd1306_dump(data, width, "Source buff");
+#define DRAW_ROP(m_expr) \
+	switch( rop ) { \
+		case ssd1306_rop_copy:    DRAW_LOOP(m_expr, s) break; \
+		case ssd1306_rop_or:      DRAW_LOOP(m_expr, buff[x] | s) break; \
+		case ssd1306_rop_and:     DRAW_LOOP(m_expr, buff[x] & s) break; \
+		case ssd1306_rop_and_not: DRAW_LOOP(m_expr, buff[x] & ~s) break; \
+		case ssd1306_rop_xor:     DRAW_LOOP(m_expr, buff[x] ^ s) break; \
+		default: \
+			ABORT_IF(true, "invalid raster operation %d", rop); \
+	}
 
-		for( unsigned x = 0; x < width; x++ ) {
-			buff[x] = (buff[x] & d_mask) | (shift_bits(data[x], s_bits) & s_mask);
-		}
+void ssd1306_draw_page(uint8_t* buff, uint16_t width,
+	const uint8_t* s_lo, const uint8_t* s_hi, uint8_t s_bits,
+	const uint8_t* m_lo, const uint8_t* m_hi, uint8_t m_bits,
+	uint8_t d_mask, ssd1306_rop_t rop)
+{
+	LOG_T("d_mask = 0x%02x, s_bits = %u, rop = %d, from %p/%p", d_mask, s_bits, rop, s_lo, s_hi);
 
-		ssd1306_dump(buff, width, "Raster buff");
+	if( m_lo ) {
+		DRAW_ROP(d_mask & fetch_bits(m_lo, m_hi, m_bits, x));
+	} else if( rop == ssd1306_rop_copy && d_mask == 0xff && s_bits == 0 ) {
+		memcpy(buff, s_lo, width);
+	} else {
+		DRAW_ROP(d_mask);
 	}
+
+	ssd1306_dump(buff, width, "Raster buff");
 }
+
+#undef DRAW_ROP
+#undef DRAW_LOOP
@@ -0,0 +1,174 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+#include <esp_timer.h>
+
+typedef struct field_build_t {
+	const ssd1306_font_t* font;
+	ssd1306_cell_t* cells;
+	uint8_t cells_z;
+	int16_t x;
+	int16_t w; // of the field, glyphs starting beyond aren't kept
+	bool invert;
+	utf8_state_t utf8;
+	uint16_t range;
+	uint16_t chars;
+} field_build_t;
+
+static void ssd1306_field_cell(void* context, char c);
+
+static inline bool same_cell(const ssd1306_cell_t* a, const ssd1306_cell_t* b)
+{
+	return a->code == b->code && a->x == b->x && a->w == b->w && a->invert == b->invert;
+}
+
+void ssd1306_field(ssd1306_t device, ssd1306_field_t* field, const char* format, ...)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(field);
+	ABORT_IF_NULL(format);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	const int64_t start = esp_timer_get_time();
+
+	field_build_t build = {
+		font: device->font,
+		cells: ssd1306_arena_alloc(dev, SSD1306_FIELD_LENGTH * sizeof(ssd1306_cell_t)),
+		w: ssd1306_bounds_width(&field->bounds),
+	};
+	va_list args;
+
+	// the text goes into cells as it's formatted, nothing is drawn yet
+	va_start(args, format);
+	ssd1306_format(ssd1306_field_cell, &build, format, args);
+	va_end(args);
+
+	const ssd1306_bounds_t row = {
+		x0: field->bounds.x0,
+		y0: field->bounds.y0,
+		x1: field->bounds.x1,
+		y1: field->bounds.y0 + device->font->height,
+	};
+	ssd1306_bounds_t trimmed = row;
+
+	if( ssd1306_trim(device, &trimmed, NULL) && ssd1306_bounds_intersect(&trimmed, &field->bounds) ) {
+		text_render_t render = {
+			dev: dev,
+			font: device->font,
+			buff: ssd1306_raster(device, trimmed.y0 >> 3),
+			stride: device->w,
+		};
+		int16_t x0 = INT16_MAX;
+		int16_t x1 = INT16_MIN;
+
+		ssd1306_text_setup(&render, &row, &trimmed);
+
+		if( !field->drawn ) {
+			ssd1306_clear_internal(device, &trimmed);
+
+			x0 = trimmed.x0;
+			x1 = trimmed.x1;
+		}
+
+		for( uint8_t k = 0; k < build.cells_z; k++ ) {
+			const ssd1306_cell_t* cell = build.cells + k;
+
+			if( field->drawn && k < field->cells_z && same_cell(cell, field->cells + k) ) {
+				continue;
+			}
+
+			render.x = row.x0 + cell->x;
+			render.invert = cell->invert;
+
+			ssd1306_text_glyph(&render, cell->code);
+
+			x0 = mini(x0, row.x0 + cell->x);
+			x1 = maxi(x1, row.x0 + cell->x + cell->w);
+		}
+
+		// what's left of a longer text
+		if( field->drawn && field->w > build.x ) {
+			const ssd1306_bounds_t tail = { x0: row.x0 + build.x, y0: row.y0, x1: row.x0 + field->w, y1: row.y1 };
+			ssd1306_bounds_t cleared = tail;
+
+			if( ssd1306_bounds_intersect(&cleared, &trimmed) ) {
+				ssd1306_clear_internal(device, &cleared);
+			}
+
+			x0 = mini(x0, tail.x0);
+			x1 = maxi(x1, tail.x1);
+		}
+
+		// only the changed columns go to the display
+		trimmed.x0 = maxi(trimmed.x0, x0);
+		trimmed.x1 = mini(trimmed.x1, x1);
+
+		if( trimmed.x0 < trimmed.x1 ) {
+			ssd1306_update_internal(device, &trimmed);
+		}
+
+		LOG_D("field updated in columns [%d, %d)", x0, x1);
+	} else {
+		LOG_W("not visible");
+	}
+
+	memcpy(field->cells, build.cells, build.cells_z * sizeof(ssd1306_cell_t));
+
+	field->cells_z = build.cells_z;
+	field->w = build.x;
+	field->drawn = true;
+
+	dev->stats.text_chars += build.chars;
+	dev->stats.text_us += esp_timer_get_time() - start;
+
+	ssd1306_arena_free(dev, build.cells);
+	ssd1306_release(device);
+}
+
+/*
+	Decodes the formatted text into the cells of the glyphs, positioned
+	as they would be drawn. Characters outside of the font take no cell.
+*/
+void ssd1306_field_cell(void* context, char c)
+{
+	field_build_t* build = context;
+	const int32_t code = ssd1306_utf8_next(&build->utf8, c);
+
+	if( code < 0 ) {
+		return;
+	}
+
+	build->chars++;
+
+	if( code == CONFIG_SSD1306_TEXT_INVERT ) {
+		build->invert = !build->invert;
+
+		return;
+	}
+	if( build->cells_z == SSD1306_FIELD_LENGTH || build->x >= build->w ) {
+		return;
+	}
+
+	const ssd1306_glyph_t* glyph = ssd1306_font_glyph(build->font, code, &build->range);
+
+	if( glyph == NULL ) {
+		return;
+	}
+
+	build->cells[build->cells_z++] = (ssd1306_cell_t){
+		code: code,
+		x: build->x,
+		w: glyph->w,
+		invert: build->invert,
+	};
+
+	build->x += glyph->w;
+}
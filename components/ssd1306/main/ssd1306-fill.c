@@ -0,0 +1,194 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+const ssd1306_pattern_t ssd1306_pattern_checker = {
+	image: { 0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa },
+};
+const ssd1306_pattern_t ssd1306_pattern_light = {
+	image: { 0x11, 0x00, 0x44, 0x00, 0x11, 0x00, 0x44, 0x00 },
+};
+const ssd1306_pattern_t ssd1306_pattern_dark = {
+	image: { 0xee, 0xff, 0xbb, 0xff, 0xee, 0xff, 0xbb, 0xff },
+};
+
+static const ssd1306_pattern_t pattern_zero = { image: { 0 } };
+static const ssd1306_pattern_t pattern_ones = { image: { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+
+static void ssd1306_fill_page(uint8_t* buff, uint16_t x0, uint16_t x1,
+	const uint8_t* and_bits, const uint8_t* xor_bits);
+
+void ssd1306_fill(ssd1306_t device, const ssd1306_bounds_t* target, bool value)
+{
+	ssd1306_fill_pattern(device, target, value ? &pattern_ones : &pattern_zero, ssd1306_rop_copy);
+}
+
+void ssd1306_fill_gray(ssd1306_t device, const ssd1306_bounds_t* target, uint8_t level)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF(level > 3, "invalid gray level %u", level);
+	ABORT_IF(!device->grayscale, "gray levels need grayscale mode");
+
+	ssd1306_int_t const dev = (ssd1306_int_t)device;
+	ssd1306_bounds_t d_bounds;
+
+	if( !ssd1306_adjust_target_bounds(&d_bounds, device, target) ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	uint8_t* const raster = dev->raster;
+
+	for( uint8_t plane = 0; plane < 2; plane++ ) {
+		dev->raster = dev->planes[plane];
+
+		ssd1306_fill_internal(device, &d_bounds, level & (1 << plane) ? &pattern_ones : &pattern_zero, ssd1306_rop_copy);
+	}
+
+	dev->raster = raster;
+
+	ssd1306_update_internal(device, &d_bounds);
+	ssd1306_release(device);
+}
+
+void ssd1306_invert_region(ssd1306_t device, const ssd1306_bounds_t* target)
+{
+	ssd1306_fill_pattern(device, target, &pattern_ones, ssd1306_rop_xor);
+}
+
+void ssd1306_fill_pattern(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_pattern_t* pattern, ssd1306_rop_t rop)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(pattern);
+
+	ssd1306_bounds_t d_bounds;
+
+	if( !ssd1306_adjust_target_bounds(&d_bounds, device, target) ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_fill_internal(device, &d_bounds, pattern, rop);
+	ssd1306_update_internal(device, &d_bounds);
+
+	ssd1306_release(device);
+}
+
+/*
+	Every raster op is reduced to target = (target & A) ^ X, with A and X
+	derived from the pattern; bits outside of the page mask keep A set
+	and X clear, so partial pages need no special case.
+*/
+void ssd1306_fill_internal(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_pattern_t* pattern, ssd1306_rop_t rop)
+{
+	const int16_t t_page = target->y0 >> 3;
+	const int16_t b_page = (target->y1 - 1) >> 3;
+
+	uint8_t and_bits[8];
+	uint8_t xor_bits[8];
+
+	for( int16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t y = page * SSD1306_PAGE_HEIGHT;
+		const uint8_t d_mask = page_mask(
+			target->y0 > y ? target->y0 - y : 0,
+			target->y1 < y + 8 ? target->y1 - y : 8);
+
+		bool noop = true;
+
+		for( unsigned k = 0; k < 8; k++ ) {
+			const uint8_t p = pattern->image[k];
+			uint8_t a, x;
+
+			switch( rop ) {
+				case ssd1306_rop_copy:    a = 0;  x = p; break;
+				case ssd1306_rop_or:      a = ~p; x = p; break;
+				case ssd1306_rop_and:     a = p;  x = 0; break;
+				case ssd1306_rop_and_not: a = ~p; x = 0; break;
+				case ssd1306_rop_xor:     a = 0xff; x = p; break;
+				default:
+					ABORT_IF(true, "invalid raster operation %d", rop);
+			}
+
+			and_bits[k] = a | ~d_mask;
+			xor_bits[k] = x & d_mask;
+
+			noop = noop && and_bits[k] == 0xff && xor_bits[k] == 0;
+		}
+
+		if( noop ) {
+			continue;
+		}
+
+		LOG_T("fill page %d with mask 0x%02x", page, d_mask);
+
+		ssd1306_fill_page(ssd1306_raster(device, page), target->x0, target->x1, and_bits, xor_bits);
+	}
+}
+
+/*
+	Fills columns [x0, x1) of a page. The bits are indexed by the column
+	modulo 8; the aligned middle is stored a word at a time, or with a
+	single memset when the result doesn't depend on the target.
+*/
+void ssd1306_fill_page(uint8_t* buff, uint16_t x0, uint16_t x1,
+	const uint8_t* and_bits, const uint8_t* xor_bits)
+{
+	uint16_t x = x0;
+
+	while( x < x1 && ((uintptr_t)(buff + x) & 3) ) {
+		buff[x] = (buff[x] & and_bits[x & 7]) ^ xor_bits[x & 7];
+		x++;
+	}
+
+	const uint16_t words = (x1 - x) / 4;
+
+	if( words ) {
+		uint8_t a8[8];
+		uint8_t x8[8];
+
+		for( unsigned k = 0; k < 8; k++ ) {
+			a8[k] = and_bits[(x + k) & 7];
+			x8[k] = xor_bits[(x + k) & 7];
+		}
+
+		uint32_t a[2];
+		uint32_t w[2];
+
+		memcpy(a, a8, sizeof(a));
+		memcpy(w, x8, sizeof(w));
+
+		uint32_t* word = (uint32_t*)(buff + x);
+
+		if( a[0] == 0 && a[1] == 0 ) {
+			if( memcmp(x8, x8 + 1, 7) == 0 ) {
+				memset(word, x8[0], words * 4);
+			} else {
+				for( uint16_t k = 0; k < words; k++ ) {
+					word[k] = w[k & 1];
+				}
+			}
+		} else {
+			for( uint16_t k = 0; k < words; k++ ) {
+				word[k] = (word[k] & a[k & 1]) ^ w[k & 1];
+			}
+		}
+
+		x += words * 4;
+	}
+
+	while( x < x1 ) {
+		buff[x] = (buff[x] & and_bits[x & 7]) ^ xor_bits[x & 7];
+		x++;
+	}
+}
@@ -0,0 +1,34 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+/*
+	Binary search of the ranges, for a code point outside the one hinted.
+	The hint is updated to the range found, returns NULL when the code
+	point isn't in the font.
+*/
+const ssd1306_glyph_t* ssd1306_font_find(const ssd1306_font_t* font, uint32_t code, uint16_t* hint)
+{
+	uint16_t lo = 0;
+	uint16_t hi = font->ranges_z;
+
+	while( lo < hi ) {
+		const uint16_t mid = (lo + hi) / 2;
+		const ssd1306_font_range_t* range = font->ranges + mid;
+
+		if( code < range->first ) {
+			hi = mid;
+		} else if( code - range->first >= range->count ) {
+			lo = mid + 1;
+		} else {
+			const ssd1306_glyph_t* glyph = ssd1306_font_glyphs(font) + range->glyph + (code - range->first);
+
+			*hint = mid;
+
+			return glyph->w ? glyph : NULL;
+		}
+	}
+
+	return NULL;
+}
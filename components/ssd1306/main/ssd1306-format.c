@@ -0,0 +1,347 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ssd1306-int.h"
+
+typedef struct format_spec_t {
+	bool left;
+	bool zero;
+	bool alt;
+	char sign; // '+', ' ' or 0
+	int16_t width;
+	int16_t precision; // -1 when not given
+	char length; // 'H' for hh, 'L' for ll, or h, l, z, j, t
+} format_spec_t;
+
+typedef struct format_out_t {
+	ssd1306_sink_t sink;
+	void* context;
+	uint16_t count;
+} format_out_t;
+
+static const char* parse_spec(const char* format, format_spec_t* spec, va_list* args);
+static void format_integer(format_out_t* out, const format_spec_t* spec, char conv, va_list* args);
+static void format_float(format_out_t* out, const format_spec_t* spec, char conv, va_list* args);
+static void format_string(format_out_t* out, const format_spec_t* spec, const char* text, uint16_t length);
+
+static inline void emit(format_out_t* out, char c)
+{
+	out->sink(out->context, c);
+	out->count++;
+}
+
+static inline void emit_n(format_out_t* out, char c, int16_t n)
+{
+	for( ; n > 0; n-- ) {
+		emit(out, c);
+	}
+}
+
+/*
+	A printf subset streaming each character into the sink, without any
+	intermediate buffer. Integers, characters and strings are converted
+	here, floating point goes through snprintf one conversion at a time.
+	Returns the number of characters emitted.
+*/
+uint16_t ssd1306_format(ssd1306_sink_t sink, void* context, const char* format, va_list args)
+{
+	format_out_t out = { sink: sink, context: context, count: 0 };
+	va_list ap;
+
+	// a copy can be walked through a pointer, the parameter might be an array
+	va_copy(ap, args);
+
+	while( *format ) {
+		if( *format != '%' ) {
+			emit(&out, *format++);
+
+			continue;
+		}
+
+		const char* start = format++;
+		format_spec_t spec;
+
+		format = parse_spec(format, &spec, &ap);
+
+		const char conv = *format;
+
+		if( conv ) {
+			format++;
+		}
+
+		switch( conv ) {
+			case '%':
+				emit(&out, '%');
+			break;
+
+			case 'd': case 'i': case 'u':
+			case 'x': case 'X': case 'o': case 'p':
+				format_integer(&out, &spec, conv, &ap);
+			break;
+
+			case 'c': {
+				const char c = va_arg(ap, int);
+
+				format_string(&out, &spec, &c, 1);
+			}
+			break;
+
+			case 's': {
+				const char* text = va_arg(ap, const char*);
+
+				if( text == NULL ) {
+					text = "(null)";
+				}
+
+				uint16_t length = 0;
+
+				while( text[length] && (spec.precision < 0 || length < spec.precision) ) {
+					length++;
+				}
+
+				format_string(&out, &spec, text, length);
+			}
+			break;
+
+			case 'f': case 'F': case 'e': case 'E':
+			case 'g': case 'G': case 'a': case 'A':
+				format_float(&out, &spec, conv, &ap);
+			break;
+
+			default:
+				// unsupported, shown as written
+				while( start < format ) {
+					emit(&out, *start++);
+				}
+			break;
+		}
+	}
+
+	va_end(ap);
+
+	return out.count;
+}
+
+const char* parse_spec(const char* format, format_spec_t* spec, va_list* args)
+{
+	memset(spec, 0, sizeof(*spec));
+
+	spec->precision = -1;
+
+	for( ; ; format++ ) {
+		switch( *format ) {
+			case '-': spec->left = true; continue;
+			case '0': spec->zero = true; continue;
+			case '#': spec->alt = true; continue;
+			case '+': spec->sign = '+'; continue;
+			case ' ': spec->sign = spec->sign ? spec->sign : ' '; continue;
+		}
+
+		break;
+	}
+
+	if( *format == '*' ) {
+		spec->width = va_arg(*args, int);
+		format++;
+
+		if( spec->width < 0 ) {
+			spec->left = true;
+			spec->width = -spec->width;
+		}
+	} else {
+		while( *format >= '0' && *format <= '9' ) {
+			spec->width = spec->width * 10 + (*format++ - '0');
+		}
+	}
+
+	if( *format == '.' ) {
+		format++;
+		spec->precision = 0;
+
+		if( *format == '*' ) {
+			spec->precision = va_arg(*args, int);
+			format++;
+		} else {
+			while( *format >= '0' && *format <= '9' ) {
+				spec->precision = spec->precision * 10 + (*format++ - '0');
+			}
+		}
+	}
+
+	switch( *format ) {
+		case 'h':
+		case 'l':
+			spec->length = *format++;
+
+			if( *format == spec->length ) {
+				spec->length = spec->length == 'h' ? 'H' : 'L';
+				format++;
+			}
+		break;
+
+		case 'z': case 'j': case 't': case 'L':
+			spec->length = *format++;
+		break;
+	}
+
+	return format;
+}
+
+/*
+	Digits are produced backwards into a small buffer, in 32 bits whenever
+	the value fits, 64-bit division being a library call on our targets.
+*/
+void format_integer(format_out_t* out, const format_spec_t* spec, char conv, va_list* args)
+{
+	const bool is_signed = conv == 'd' || conv == 'i';
+	unsigned long long value;
+	bool negative = false;
+
+	if( conv == 'p' ) {
+		value = (uintptr_t)va_arg(*args, void*);
+	} else if( is_signed ) {
+		long long number;
+
+		switch( spec->length ) {
+			case 'L': number = va_arg(*args, long long); break;
+			case 'l': number = va_arg(*args, long); break;
+			case 'j': number = va_arg(*args, intmax_t); break;
+			case 'z': case 't': number = va_arg(*args, ptrdiff_t); break;
+			case 'H': number = (signed char)va_arg(*args, int); break;
+			case 'h': number = (short)va_arg(*args, int); break;
+			default: number = va_arg(*args, int); break;
+		}
+
+		negative = number < 0;
+		value = negative ? 0ULL - (unsigned long long)number : (unsigned long long)number;
+	} else {
+		switch( spec->length ) {
+			case 'L': value = va_arg(*args, unsigned long long); break;
+			case 'l': value = va_arg(*args, unsigned long); break;
+			case 'j': value = va_arg(*args, uintmax_t); break;
+			case 'z': case 't': value = va_arg(*args, size_t); break;
+			case 'H': value = (unsigned char)va_arg(*args, unsigned); break;
+			case 'h': value = (unsigned short)va_arg(*args, unsigned); break;
+			default: value = va_arg(*args, unsigned); break;
+		}
+	}
+
+	const uint8_t base = conv == 'o' ? 8 : (conv == 'x' || conv == 'X' || conv == 'p') ? 16 : 10;
+	const char* digits = conv == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+
+	char buff[24]; // 22 octal digits for 64 bits
+	uint8_t length = 0;
+
+	if( value <= UINT32_MAX ) {
+		for( uint32_t v = value; v; v /= base ) {
+			buff[sizeof(buff) - ++length] = digits[v % base];
+		}
+	} else {
+		for( unsigned long long v = value; v; v /= base ) {
+			buff[sizeof(buff) - ++length] = digits[v % base];
+		}
+	}
+
+	// the precision is the minimum number of digits, zero shows nothing
+	const int16_t precision = spec->precision < 0 ? 1 : spec->precision;
+	const int16_t zeros = precision > length ? precision - length : 0;
+
+	char prefix[2];
+	uint8_t prefix_z = 0;
+
+	if( negative ) {
+		prefix[prefix_z++] = '-';
+	} else if( is_signed && spec->sign ) {
+		prefix[prefix_z++] = spec->sign;
+	}
+
+	if( conv == 'p' || (spec->alt && value && base == 16) ) {
+		prefix[prefix_z++] = '0';
+		prefix[prefix_z++] = conv == 'X' ? 'X' : 'x';
+	} else if( spec->alt && base == 8 && zeros == 0 && value ) {
+		prefix[prefix_z++] = '0';
+	}
+
+	const int16_t total = prefix_z + zeros + length;
+	const int16_t padding = spec->width > total ? spec->width - total : 0;
+	const bool zero_pad = spec->zero && !spec->left && spec->precision < 0;
+
+	if( !spec->left && !zero_pad ) {
+		emit_n(out, ' ', padding);
+	}
+
+	for( uint8_t k = 0; k < prefix_z; k++ ) {
+		emit(out, prefix[k]);
+	}
+
+	emit_n(out, '0', zeros + (zero_pad ? padding : 0));
+
+	for( uint8_t k = sizeof(buff) - length; k < sizeof(buff); k++ ) {
+		emit(out, buff[k]);
+	}
+
+	if( spec->left ) {
+		emit_n(out, ' ', padding);
+	}
+}
+
+/*
+	The conversion is rebuilt and handed to snprintf, anything beyond what
+	a display line could show is dropped.
+*/
+void format_float(format_out_t* out, const format_spec_t* spec, char conv, va_list* args)
+{
+	char format[16];
+	char* p = format;
+
+	*p++ = '%';
+
+	if( spec->left ) *p++ = '-';
+	if( spec->zero ) *p++ = '0';
+	if( spec->alt ) *p++ = '#';
+	if( spec->sign ) *p++ = spec->sign;
+
+	*p++ = '*';
+	*p++ = '.';
+	*p++ = '*';
+
+	if( spec->length == 'L' ) {
+		*p++ = 'L';
+	}
+
+	*p++ = conv;
+	*p = 0;
+
+	char buff[48];
+	int length;
+
+	if( spec->length == 'L' ) {
+		length = snprintf(buff, sizeof(buff), format, spec->width, spec->precision, va_arg(*args, long double));
+	} else {
+		length = snprintf(buff, sizeof(buff), format, spec->width, spec->precision, va_arg(*args, double));
+	}
+
+	for( int k = 0; k < length && k < (int)sizeof(buff) - 1; k++ ) {
+		emit(out, buff[k]);
+	}
+}
+
+void format_string(format_out_t* out, const format_spec_t* spec, const char* text, uint16_t length)
+{
+	const int16_t padding = spec->width > length ? spec->width - length : 0;
+
+	if( !spec->left ) {
+		emit_n(out, ' ', padding);
+	}
+
+	for( uint16_t k = 0; k < length; k++ ) {
+		emit(out, text[k]);
+	}
+
+	if( spec->left ) {
+		emit_n(out, ' ', padding);
+	}
+}
@@ -0,0 +1,68 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+ssd1306_bitmap_t* ssd1306_create_bitmap_rows(const ssd1306_size_t size,
+	const uint8_t* data, uint16_t stride, ssd1306_bit_order_t order)
+{
+	ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap(size);
+
+	ssd1306_bitmap_import(bitmap, 0, size.h, data, stride, order);
+
+	return bitmap;
+}
+
+/*
+	Rows are converted in blocks of 8x8 pixels: the 8 bytes found at the
+	same offset of 8 consecutive rows are transposed into 8 page-major
+	columns. Rows outside of the band read as zero and are masked out, so
+	bands don't need to start or end at page boundaries.
+*/
+void ssd1306_bitmap_import(ssd1306_bitmap_t* bitmap, uint16_t y, uint16_t rows,
+	const uint8_t* data, uint16_t stride, ssd1306_bit_order_t order)
+{
+	ABORT_IF_NULL(bitmap);
+	ABORT_IF_NULL(data);
+	ABORT_IF(stride < bytes_cap(bitmap->w), "stride %u too small for width %u", stride, bitmap->w);
+
+	if( y >= bitmap->h ) {
+		return;
+	}
+
+	rows = minu(rows, bitmap->h - y);
+
+	const uint16_t y1 = y + rows;
+	const uint16_t t_page = y / 8;
+	const uint16_t b_page = (y1 - 1) / 8;
+
+	LOG_D("importing rows [%u, %u) into pages [%u, %u]", y, y1, t_page, b_page);
+
+	for( uint16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t row = page * 8 - y; // band row landing on bit 0
+		const uint8_t lo = row < 0 ? -row : 0;
+		const uint8_t hi = row + 8 > rows ? rows - row : 8;
+		const uint8_t d_mask = page_mask(lo, hi);
+
+		uint8_t* target = bitmap->image + page * bitmap->w;
+
+		for( uint16_t x = 0; x < bitmap->w; x += 8 ) {
+			uint8_t block[8] = { };
+			uint8_t tile[8];
+
+			for( unsigned j = lo; j < hi; j++ ) {
+				block[j] = data[(row + j) * stride + x / 8];
+			}
+
+			ssd1306_transpose8(block, 1, tile, 1);
+
+			const unsigned count = minu(8, bitmap->w - x);
+
+			for( unsigned k = 0; k < count; k++ ) {
+				const uint8_t bits = tile[order == ssd1306_msb_first ? 7 - k : k];
+
+				target[x + k] = (target[x + k] & ~d_mask) | (bits & d_mask);
+			}
+		}
+	}
+}
@@ -7,6 +7,14 @@
 #include <assert.h>
 #include <ctype.h>
 
+// whole sets only
+#define SHIFT_CACHE_SIZE (CONFIG_SSD1306_SHIFT_CACHE / SSD1306_SHIFT_WAYS * SSD1306_SHIFT_WAYS)
+#define STATUS_SCROLL_SPEED 25 // pixels per second
+#define STATUS_SCROLL_PAUSE 2500 // milliseconds
+
+// keeps the arena aligned
+#define LABEL_CACHE_SIZE ((CONFIG_SSD1306_LABEL_CACHE + 3) & ~3)
+
 static void ssd1306_init_private(ssd1306_int_t dev, const ssd1306_init_t init, uint8_t pages);
 static void ssd1306_init_status(ssd1306_int_t dev, ssd1306_status_t status);
 static void ssd1306_init_screen(ssd1306_int_t dev, const ssd1306_init_t ini);
@@ -47,10 +55,17 @@ ssd1306_t ssd1306_init(ssd1306_init_t init)
 	}
 
 	ABORT_IF(init->font == NULL, "no font provided");
+	ABORT_IF(init->font->height == 0 || init->font->height > SSD1306_GLYPH_PAGES * SSD1306_PAGE_HEIGHT,
+		"invalid font height %u", init->font->height);
+	ABORT_IF(init->font->ranges_z == 0, "font without glyphs");
 
-	// allocate additional bytes for internal buffer and raster
+	// allocate additional bytes for internal buffer and raster, plus the second plane
+	// in grayscale mode and the frame in portrait mode, followed by the shift cache,
+	// the label cache and the scratch arena
 	const uint8_t pages = 4 * ((int)init->panel + 1);
-	const size_t total = sizeof(ssd1306_int_s) + pages * CONFIG_SSD1306_WIDTH;
+	const uint8_t buffers = 1 + (init->grayscale ? 1 : 0) + (init->portrait ? 1 : 0);
+	const size_t total = sizeof(ssd1306_int_s) + buffers * pages * CONFIG_SSD1306_WIDTH
+		+ SHIFT_CACHE_SIZE * sizeof(shift_entry_t) + LABEL_CACHE_SIZE + CONFIG_SSD1306_ARENA_SIZE;
 
 	ssd1306_int_t dev = calloc(1, total);
 
@@ -68,6 +83,11 @@ ssd1306_t ssd1306_init(ssd1306_init_t init)
 	LOG_I("    Size: %ux%u (%u pages)", dev->w, dev->h, dev->pages);
 	LOG_I("    Bounds: [%+d%+d, %+d%+d]", dev->x0, dev->y0, dev->x1, dev->y1);
 	LOG_I("    Flip: %s", dev->flip ? "yes" : "no");
+	LOG_I("    Portrait: %s", dev->portrait ? "yes" : "no");
+	LOG_I("    Grayscale: %s", dev->grayscale ? "yes" : "no");
+	LOG_I("    Arena: %u bytes", dev->arena.size);
+	LOG_I("    Shift cache: %u entries", dev->shift.size);
+	LOG_I("    Label cache: %u bytes", dev->label.size);
 	LOG_I("    Contrast: %d", init->contrast);
 	LOG_I("    Invert: %d", init->invert);
 
@@ -160,10 +180,39 @@ void ssd1306_free(ssd1306_t device)
 
 void ssd1306_init_private(ssd1306_int_t dev, const ssd1306_init_t ini, uint8_t pages)
 {
+	const size_t raster = pages * CONFIG_SSD1306_WIDTH;
+
 	dev->flip = ini->flip;
-	dev->x1 = dev->size.w = CONFIG_SSD1306_WIDTH;
-	dev->y1 = dev->size.h = pages * SSD1306_PAGE_HEIGHT;
-	dev->pages = pages;
+	dev->portrait = ini->portrait;
+	dev->grayscale = ini->grayscale;
+	dev->panel.w = CONFIG_SSD1306_WIDTH;
+	dev->panel.h = pages * SSD1306_PAGE_HEIGHT;
+
+	dev->planes[0] = dev->buff;
+	dev->planes[1] = dev->grayscale ? dev->buff + raster : dev->buff;
+	dev->raster = dev->planes[0];
+
+	if( dev->portrait ) {
+		dev->x1 = dev->size.w = dev->panel.h;
+		dev->y1 = dev->size.h = dev->panel.w;
+		dev->pages = dev->panel.w / SSD1306_PAGE_HEIGHT;
+		dev->frame = dev->planes[1] + raster;
+	} else {
+		dev->x1 = dev->size.w = dev->panel.w;
+		dev->y1 = dev->size.h = dev->panel.h;
+		dev->pages = pages;
+		dev->frame = NULL;
+	}
+
+	dev->shift.entries = (shift_entry_t*)((dev->portrait ? dev->frame : dev->planes[1]) + raster);
+	dev->shift.size = SHIFT_CACHE_SIZE;
+
+	dev->label.pool = (uint8_t*)(dev->shift.entries + dev->shift.size);
+	dev->label.size = LABEL_CACHE_SIZE;
+
+	dev->arena.base = dev->label.pool + dev->label.size;
+	dev->arena.size = CONFIG_SSD1306_ARENA_SIZE;
+
 	dev->font = ini->font;
 	
 	memcpy((void*)&dev->connection, &ini->connection, sizeof(dev->connection));
@@ -174,23 +223,39 @@ void ssd1306_init_status(ssd1306_int_t dev, ssd1306_status_t status)
 	uint16_t index = ssd1306_status_index(dev, status);
 	ssd1306_bounds_t* bounds = (ssd1306_bounds_t*)&dev->statuses[index];
 
+	// status lines take whole pages, they scroll page by page
+	const uint16_t height = bytes_cap(dev->font->height) * SSD1306_PAGE_HEIGHT;
+
 	bounds->x0 = 0;
-	bounds->y0 = dev->flip ? dev->h - SSD1306_TEXT_HEIGHT * (2-index) : SSD1306_TEXT_HEIGHT * index;
+	bounds->y0 = dev->flip ? dev->h - height * (2-index) : height * index;
 	bounds->x1 = dev->w;
-	bounds->y1 = bounds->y0 + SSD1306_TEXT_HEIGHT;
+	bounds->y1 = bounds->y0 + height;
+
+	ticker_info_t* ticker = &dev->statuses[index].ticker;
+
+	ticker->bounds = *bounds;
+	ticker->config = (ssd1306_ticker_config_t){
+		speed: STATUS_SCROLL_SPEED,
+		pause_ms: STATUS_SCROLL_PAUSE,
+		direction: ssd1306_ticker_left,
+	};
 }
 
 void ssd1306_init_screen(ssd1306_int_t dev, const ssd1306_init_t ini)
 {
+	// the transposition on update mirrors the image, mirroring one axis back rotates it
+	const bool remap = dev->portrait ? true : !dev->flip;
+	const bool scan = dev->portrait ? dev->flip : !dev->flip;
+
 	const uint8_t data[] = {
 		OLED_CMD0(DISPLAY_OFF),
 
-		OLED_CMD2(SET_MUX_RATIO, dev->h-1),
-		OLED_CMD1(SET_SEGMENT_REMAP, dev->flip ? 0x00 : 0x01),
-		OLED_CMD1(SET_COM_SCAN_MODE, dev->flip ? 0x00 : 0x08),
+		OLED_CMD2(SET_MUX_RATIO, dev->panel.h-1),
+		OLED_CMD1(SET_SEGMENT_REMAP, remap ? 0x01 : 0x00),
+		OLED_CMD1(SET_COM_SCAN_MODE, scan ? 0x08 : 0x00),
 		OLED_CMD2(SET_DISPLAY_CLK_DIV, 0x80),
 
-		OLED_CMD2(SET_COM_PIN_MAP, dev->h == 64 ? 0x12:  0x02),
+		OLED_CMD2(SET_COM_PIN_MAP, dev->panel.h == 64 ? 0x12:  0x02),
 		OLED_CMD2(SET_VCOMH_DESELCT, 0x40),
 		OLED_CMD2(SET_CHARGE_PUMP, 0x14),
 		OLED_CMD2(SET_PRECHARGE, 0xf1),
@@ -202,8 +267,8 @@ void ssd1306_init_screen(ssd1306_int_t dev, const ssd1306_init_t ini)
 		OLED_CMD2(SET_MEMORY_ADDR_MODE, OLED_HORI_ADDR_MODE),
 
 #if !CONFIG_SSD1306_OPTIMIZE
-		OLED_CMD3(SET_COLUMN_RANGE, 0, dev->w-1),
-		OLED_CMD3(SET_PAGE_RANGE, 0, dev->pages-1),
+		OLED_CMD3(SET_COLUMN_RANGE, 0, dev->panel.w-1),
+		OLED_CMD3(SET_PAGE_RANGE, 0, dev->panel.h/8-1),
 #endif
 
 		OLED_CMD0(DEACTIVE_SCROLL),
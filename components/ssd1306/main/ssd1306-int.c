@@ -6,19 +6,18 @@
 
 #include <esp_timer.h>
 
-#define SCREEN_SCROLL_FPS   25
-#define SCREEN_SCROLL_TICKS pdMS_TO_TICKS(1000/SCREEN_SCROLL_FPS)
-
 const ssd1306_point_t POINT_ZERO = {};
 
-static void update_region(ssd1306_int_t dev, const ssd1306_bounds_t* bounds);
+static void update_region(ssd1306_int_t dev, const ssd1306_bounds_t* bounds, const uint8_t* plane);
+static void transpose_region(ssd1306_int_t dev, ssd1306_bounds_t* region, const uint8_t* plane);
 
-static const status_info_t* update_status(ssd1306_int_t dev, uint8_t index, ssd1306_bounds_t* bounds);
-static void move_status(ssd1306_int_t dev, status_info_t* status, ssd1306_bounds_t* bounds);
+static TickType_t gray_subframe(ssd1306_int_t dev);
+static void gray_pend(gray_info_t* gray, const ssd1306_bounds_t* bounds);
+static bool planes_difference(ssd1306_int_t dev, ssd1306_bounds_t* bounds);
 
-static inline bool is_move(const status_info_t* status)
+static inline TickType_t us_to_ticks(int64_t us)
 {
-	return status && status->state == anim_move;
+	return (TickType_t)((us * configTICK_RATE_HZ + 999999) / 1000000);
 }
 
 void ssd1306_task(ssd1306_int_t dev)
@@ -29,6 +28,12 @@ void ssd1306_task(ssd1306_int_t dev)
 
 	TickType_t delay = portMAX_DELAY;
 
+	if( dev->grayscale ) {
+		dev->gray.next_us = dev->gray.window_us = esp_timer_get_time();
+
+		delay = 0;
+	}
+
 	while( dev->active ) {
 		ssd1306_bounds_t bounds = dev->bounds;
 
@@ -38,13 +43,31 @@ void ssd1306_task(ssd1306_int_t dev)
 		bool notified = ulTaskNotifyTake(pdTRUE, delay);
 #endif
 		if( xSemaphoreTake(dev->mutex, portMAX_DELAY) ) {
-			const status_info_t* s0 = update_status(dev, 0, &bounds);
-			const status_info_t* s1 = update_status(dev, 1, &bounds);
+			bool drawn = false;
+
+			// one timer for all the tickers, the task sleeps until the next step is due
+			const int64_t wait_us = ssd1306_ticker_step(dev, &drawn);
+
+			ssd1306_tilemap_flush(dev, &drawn);
+
+#if CONFIG_SSD1306_OPTIMIZE
+			// empty bounds only wake the task up
+			if( notified && bounds.x1 > bounds.x0 ) {
+				ssd1306_flush_internal(dev, &bounds);
+			}
+#else
+			// every transfer is the whole frame, what the task drew goes along with the changes
+			if( notified || drawn ) {
+				ssd1306_flush_internal(dev, &bounds);
+			}
+#endif
+
+			delay = wait_us < 0 ? portMAX_DELAY : us_to_ticks(wait_us);
 
-			delay = (s0 || s1) ? SCREEN_SCROLL_TICKS : portMAX_DELAY;
+			if( dev->grayscale ) {
+				const TickType_t subframe = gray_subframe(dev);
 
-			if( notified || is_move(s0) || is_move(s1) ) {
-				update_region(dev, &bounds);
+				delay = subframe < delay ? subframe : delay;
 			}
 
 			xSemaphoreGive(dev->mutex);
@@ -52,113 +75,199 @@ void ssd1306_task(ssd1306_int_t dev)
 	}
 }
 
-void update_region(ssd1306_int_t dev, const ssd1306_bounds_t* bounds)
+/*
+	Sends a changed region, in grayscale mode it's kept until the next
+	subframe.
+*/
+void ssd1306_flush_internal(ssd1306_int_t dev, const ssd1306_bounds_t* bounds)
 {
-#if CONFIG_SSD1306_OPTIMIZE
-	const uint16_t x0 = bounds->x0;
-	const uint16_t x1 = bounds->x1;
-	const uint16_t p0 = bounds->y0 / 8;
-	const uint16_t p1 = bounds->y1 / 8 + (bounds->y1 % 8 ? 1 : 0);
+	if( dev->grayscale ) {
+		gray_pend(&dev->gray, bounds);
+	} else {
+		update_region(dev, bounds, dev->planes[0]);
+	}
+}
 
-	// LOG_D("x0 = %u, x1 = %u, p0 = %u, p1 = %u", x0, x1, p0, p1);
-#endif
+/*
+	Plane 1 is shown during two subframes out of three and plane 0 during
+	the third one, so that a pixel is lit 0, 1, 2 or 3 thirds of the time.
+	The display keeps its content between transfers, so only the changes
+	and, when switching planes, the region where they differ are sent.
+*/
+TickType_t gray_subframe(ssd1306_int_t dev)
+{
+	gray_info_t* const gray = &dev->gray;
 
-	// const uint64_t start = esp_timer_get_time();
+	const int64_t period = 1000000 / CONFIG_SSD1306_GRAYSCALE_RATE;
 
-#if CONFIG_SSD1306_OPTIMIZE
-	const uint8_t data[] = {
-		OLED_CMD_SET_COLUMN_RANGE, x0, x1 - 1,
-		OLED_CMD_SET_PAGE_RANGE, p0, p1 - 1,
-	};
+	int64_t now = esp_timer_get_time();
 
-	ssd1306_send_buff(dev, OLED_CTL_COMMAND, data, _countof(data));
+	if( now >= gray->next_us ) {
+		// keep the cadence unless a whole subframe has been missed
+		gray->next_us = now - gray->next_us < period ? gray->next_us + period : now + period;
+		gray->subframe = (gray->subframe + 1) % 3;
 
-	for( uint16_t p = p0; p < p1; p++ ) {
-		const uint8_t* buff = ssd1306_raster((ssd1306_t)dev, p);
+		const uint8_t plane = gray->subframe < 2 ? 1 : 0;
 
-		ssd1306_send_buff(dev, OLED_CTL_DATA, buff + x0, x1 - x0);
+		if( plane != gray->shown ) {
+			ssd1306_bounds_t diff;
+
+			if( planes_difference(dev, &diff) ) {
+				gray_pend(gray, &diff);
+			}
+
+			gray->shown = plane;
+		}
+
+		if( gray->subframe == 0 ) {
+			dev->stats.cycles++;
+			gray->window_cycles++;
+
+			if( now - gray->window_us >= 1000000 ) {
+				dev->stats.flicker_hz = gray->window_cycles * 1000000LL / (now - gray->window_us);
+
+				gray->window_us = now;
+				gray->window_cycles = 0;
+			}
+		}
 	}
 
-	// LOG_D("region updated in %u \u03BCs", esp_timer_get_time()-start);
-#else
-	ssd1306_send_buff(dev, OLED_CTL_DATA, dev->buff, dev->w * dev->pages);
+	if( gray->dirty ) {
+		update_region(dev, &gray->pending, dev->planes[gray->shown]);
 
-	// LOG_D("full region updated in %u \u03BCs", esp_timer_get_time()-start);
-#endif
+		gray->dirty = false;
+		now = esp_timer_get_time();
+	}
+
+	if( now >= gray->next_us ) {
+		return 0;
+	}
+
+	return us_to_ticks(gray->next_us - now);
 }
 
-const status_info_t* update_status(ssd1306_int_t dev, uint8_t index, ssd1306_bounds_t* bounds)
+void gray_pend(gray_info_t* gray, const ssd1306_bounds_t* bounds)
 {
-	status_info_t* status = dev->statuses + index;
-
-	if( status->bitmap == NULL ) {
-		return NULL;
+	if( gray->dirty ) {
+		ssd1306_bounds_union(&gray->pending, bounds);
+	} else {
+		gray->pending = *bounds;
+		gray->dirty = true;
 	}
+}
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wimplicit-fallthrough="
-	switch( status->state ) {
-		case anim_init: {
-			LOG_T("state = anim_init");
-
-			status->offset = 0;
-			status->ticks = xTaskGetTickCount();
-			status->state = anim_wait;
-		} // break-through
+bool planes_difference(ssd1306_int_t dev, ssd1306_bounds_t* bounds)
+{
+	bool found = false;
 
-		case anim_wait: {
-			TickType_t ticks = xTaskGetTickCount();
-			TickType_t milli = pdTICKS_TO_MS(ticks - status->ticks);
+	for( uint16_t page = 0; page < dev->pages; page++ ) {
+		const uint8_t* p0 = dev->planes[0] + page * dev->w;
+		const uint8_t* p1 = dev->planes[1] + page * dev->w;
 
-			if( milli < 2500 ) {
-				break;
-			}
+		if( memcmp(p0, p1, dev->w) == 0 ) {
+			continue;
+		}
 
-			status->ticks = ticks;
-			status->state = anim_move;
-		} // break-through
+		int16_t x0 = 0;
+		int16_t x1 = dev->w;
 
-		case anim_move: {
-			// LOG_T("state = anim_move, offset = %d", status->offset);
+		while( p0[x0] == p1[x0] ) {
+			x0++;
+		}
+		while( p0[x1 - 1] == p1[x1 - 1] ) {
+			x1--;
+		}
 
-			move_status(dev, status, bounds);
+		const ssd1306_bounds_t span = {
+			x0: x0, y0: page * SSD1306_PAGE_HEIGHT,
+			x1: x1, y1: (page + 1) * SSD1306_PAGE_HEIGHT,
+		};
 
-			if( status->offset == 0 ) {
-				status->ticks = xTaskGetTickCount();
-				status->state = anim_wait;
-			}
+		if( found ) {
+			ssd1306_bounds_union(bounds, &span);
+		} else {
+			*bounds = span;
+			found = true;
 		}
 	}
-#pragma GCC diagnostic pop
 
-	return status;
+	return found;
 }
 
-void move_status(ssd1306_int_t dev, status_info_t* status, ssd1306_bounds_t* bounds)
+void update_region(ssd1306_int_t dev, const ssd1306_bounds_t* bounds, const uint8_t* plane)
 {
-	int16_t offset = --status->offset;
+	const int64_t start = esp_timer_get_time();
+
+	ssd1306_bounds_t region = *bounds;
+
+	if( dev->portrait ) {
+		transpose_region(dev, &region, plane);
+
+		plane = dev->frame;
+	}
+
+#if CONFIG_SSD1306_OPTIMIZE
+	const uint16_t x0 = region.x0;
+	const uint16_t x1 = region.x1;
+	const uint16_t p0 = region.y0 / 8;
+	const uint16_t p1 = region.y1 / 8 + (region.y1 % 8 ? 1 : 0);
+
+	// LOG_D("x0 = %u, x1 = %u, p0 = %u, p1 = %u", x0, x1, p0, p1);
+
+	const uint8_t data[] = {
+		OLED_CMD_SET_COLUMN_RANGE, x0, x1 - 1,
+		OLED_CMD_SET_PAGE_RANGE, p0, p1 - 1,
+	};
+
+	ssd1306_send_buff(dev, OLED_CTL_COMMAND, data, _countof(data));
+
+	for( uint16_t p = p0; p < p1; p++ ) {
+		const uint8_t* buff = plane + p * dev->panel.w;
 
-	if( offset < -(int)status->bitmap->w ) {
-		offset = status->offset = 0;
+		ssd1306_send_buff(dev, OLED_CTL_DATA, buff + x0, x1 - x0);
 	}
 
-	uint8_t* buff = ssd1306_raster((ssd1306_t)dev, status->y0 / 8);
+	dev->stats.bytes += (x1 - x0) * (p1 - p0);
+#else
+	ssd1306_send_buff(dev, OLED_CTL_DATA, plane, dev->panel.w * dev->panel.h / 8);
+
+	dev->stats.bytes += dev->panel.w * dev->panel.h / 8;
+#endif
+
+	dev->stats.updates++;
+	dev->stats.update_us += esp_timer_get_time() - start;
+}
 
-	memset(buff, 0, dev->w);
+/*
+	In portrait mode the raster is 8 pixels high pages of the logical,
+	vertical, image. Each 8x8 tile touched by the region is transposed
+	into the frame, where raster page p and tile column t land as frame
+	page t and tile column p. The region becomes the physical one.
+*/
+void transpose_region(ssd1306_int_t dev, ssd1306_bounds_t* region, const uint8_t* plane)
+{
+	const int64_t start = esp_timer_get_time();
 
-	if( offset <= 0 ) {
-		uint16_t width = minu(dev->w, status->bitmap->w - -offset);
+	const uint16_t t0 = region->x0 / 8;
+	const uint16_t t1 = (region->x1 + 7) / 8;
+	const uint16_t p0 = region->y0 / 8;
+	const uint16_t p1 = (region->y1 + 7) / 8;
 
-		memcpy(buff, status->bitmap->image + -offset, width);
+	for( uint16_t p = p0; p < p1; p++ ) {
+		const uint8_t* tile = plane + p * dev->w + t0 * 8;
 
-		if( width < dev->w ) {
-			memcpy(buff + width, status->bitmap->image, dev->w - width);
+		for( uint16_t t = t0; t < t1; t++, tile += 8 ) {
+			ssd1306_transpose8(tile, 1, dev->frame + t * dev->panel.w + p * 8, 1);
 		}
-	} else {
-		memcpy(buff + offset, status->bitmap->image, dev->w - offset);
 	}
 
-	ssd1306_bounds_union(bounds, (ssd1306_bounds_t*)status);
+	region->x0 = p0 * 8;
+	region->y0 = t0 * 8;
+	region->x1 = p1 * 8;
+	region->y1 = t1 * 8;
+
+	dev->stats.tiles += (p1 - p0) * (t1 - t0);
+	dev->stats.transpose_us += esp_timer_get_time() - start;
 }
 
 void ssd1306_send_buff(ssd1306_int_t dev, uint8_t ctl, const uint8_t* data, uint16_t size)
@@ -3,23 +3,135 @@
 #include <ssd1306-log.h>
 #include "os.h"
 
-#define SSD1306_TEXT_HEIGHT 8
+#define SSD1306_GLYPH_PAGES 4 // of the tallest glyph
 #define SSD1306_PAGE_HEIGHT 8
+#define SSD1306_POLYGON_MAX 32 // vertices of a filled polygon
+#define SSD1306_TEXT_LENGTH 256 // formatted text kept for a bitmap, longer is truncated
+#define SSD1306_SHIFT_WIDTH 16 // widest image kept pre-shifted
+#define SSD1306_SHIFT_WAYS 4 // shift cache entries per set, evicted least recently used first
+#define SSD1306_SPRITES_MAX 16 // registered sprites
+#define SSD1306_SCALE_MAX 4 // of scaled bitmaps and text
+#define SSD1306_LABEL_ENTRIES 16 // labels cached at most, however small
+#define SSD1306_TILE_SIZE 8 // tiles of a tile map are a page high and as wide
+#define SSD1306_ARENA_DEPTH 8 // nested acquires rewinding the scratch arena, deeper ones keep it
 
-typedef enum {
-	anim_init,
-	anim_wait,
-	anim_move,
-} anim_state_t;
+#if !defined(CONFIG_SSD1306_ARENA_SIZE)
+#define CONFIG_SSD1306_ARENA_SIZE 1024
+#endif
+#if !defined(CONFIG_SSD1306_SHIFT_CACHE)
+#define CONFIG_SSD1306_SHIFT_CACHE 0
+#endif
+#if !defined(CONFIG_SSD1306_LABEL_CACHE)
+#define CONFIG_SSD1306_LABEL_CACHE 0
+#endif
+#if !defined(CONFIG_SSD1306_TEXT_UTF8)
+#define CONFIG_SSD1306_TEXT_UTF8 1
+#endif
 
-typedef struct PACKED status_info_t {
+typedef struct ssd1306_ticker_s {
+	struct ssd1306_ticker_s* next; // among the running tickers
+	ssd1306_bounds_t bounds;
+	ssd1306_ticker_config_t config;
+	ssd1306_bitmap_t* content; // kept across updates, reallocated only to grow
+	uint16_t capacity;
+	bool running; // while the content doesn't fit and moves
+	uint16_t position; // how far the content moved, up to its width or height
+	int64_t next_us; // when the next step is due
+} ticker_info_t;
+
+typedef struct ssd1306_tilemap_s {
+	struct ssd1306_tilemap_s* next; // among the tile maps of the device
+	ssd1306_bounds_t bounds;
+	const uint8_t* atlas;
+	uint16_t tiles;
+	uint8_t cols;
+	uint8_t rows;
+	ssd1306_point_t scroll; // of the region within the map, wrapped into it
+	bool full; // the whole region is composited at the next flush
+	bool pending; // composited at the next flush, the dirty cells or all of them
+	uint32_t* dirty; // a bit a cell
+	uint8_t cells[]; // tile indices, row by row
+} tilemap_info_t;
+
+typedef struct status_info_t {
 	const ssd1306_bounds_t;
-	anim_state_t state;
-	ssd1306_bitmap_t* bitmap;
-	TickType_t ticks;
-	int16_t offset;
+	ticker_info_t ticker; // scrolls a text wider than the display
+	bool valid; // the bounds show the text of hash, calling again with it is a no-op
+	uint32_t hash; // of the text, 0 when blank
 } status_info_t;
 
+typedef struct gray_info_t {
+	ssd1306_bounds_t pending; // changed since the last transfer
+	bool dirty;
+	uint8_t subframe;
+	uint8_t shown; // the plane on the display
+	int64_t next_us; // when the next subframe is due
+	int64_t window_us; // start of the flicker rate measurement
+	uint32_t window_cycles;
+} gray_info_t;
+
+typedef struct arena_info_t {
+	uint8_t* base;
+	size_t size;
+	size_t used;
+	uint8_t depth; // nesting of ssd1306_acquire
+	size_t marks[SSD1306_ARENA_DEPTH]; // used when each level was acquired
+} arena_info_t;
+
+typedef struct shift_entry_t {
+	const uint8_t* image; // the key with shift and w, NULL when free
+	uint32_t used; // clock of the last lookup
+	uint8_t shift;
+	uint8_t w;
+	uint8_t lo[SSD1306_SHIFT_WIDTH]; // rows landing in the top page
+	uint8_t hi[SSD1306_SHIFT_WIDTH]; // rows spilling into the next one
+} shift_entry_t;
+
+typedef struct shift_cache_t {
+	shift_entry_t* entries;
+	uint16_t size;
+	uint32_t clock;
+	const ssd1306_bitmap_t* sprites[SSD1306_SPRITES_MAX];
+} shift_cache_t;
+
+typedef struct label_entry_t {
+	const ssd1306_font_t* font; // the key with hash, text and invert, NULL when free
+	uint32_t hash; // of the text
+	uint32_t used; // clock of the last lookup
+	uint16_t offset; // of the bitmap in the pool, the text follows its image
+	uint16_t length;
+	bool invert;
+} label_entry_t;
+
+typedef struct label_cache_t {
+	uint8_t* pool;
+	uint16_t size;
+	uint16_t used; // entries are kept packed from the start of the pool
+	uint32_t clock;
+	label_entry_t entries[SSD1306_LABEL_ENTRIES];
+} label_cache_t;
+
+typedef struct utf8_state_t {
+	uint32_t code; // decoded so far
+	uint8_t pending; // continuation bytes still expected
+} utf8_state_t;
+
+typedef struct text_render_t {
+	ssd1306_int_t dev; // for the shift cache, NULL when rendering into a bitmap
+	const ssd1306_font_t* font;
+	uint8_t* buff; // the first page written
+	uint16_t stride; // bytes between two pages of buff
+	uint8_t pages; // written pages, the text row might straddle one more than the glyphs have
+	uint8_t masks[SSD1306_GLYPH_PAGES + 1]; // the rows written in each page
+	int8_t shift; // where the glyph top lands in the first page, negative when clipped above
+	int16_t x; // where the next glyph goes
+	int16_t x0, x1; // the visible columns
+	bool invert;
+	utf8_state_t utf8;
+	uint16_t range; // of the previous glyph, where the next one is looked up first
+	uint16_t chars; // decoded so far
+} text_render_t;
+
 typedef struct ssd1306_int_s {
 	struct ssd1306_s;
 
@@ -42,14 +154,58 @@ typedef struct ssd1306_int_s {
 	SemaphoreHandle_t mutex;
 
 	status_info_t statuses[2];
+	ticker_info_t* tickers; // the running ones, stepped by the task
+	tilemap_info_t* tilemaps; // composited by the task
+	ssd1306_stats_t stats;
+
+	ssd1306_size_t panel; // the physical size, differs from size in portrait mode
+	uint8_t* frame; // what's sent to the display in portrait mode, the transposed raster
+
+	uint8_t* raster; // the plane being drawn into
+	uint8_t* planes[2]; // both the same unless in grayscale mode
+	gray_info_t gray;
+
+	arena_info_t arena; // scratch memory, reclaimed by the matching release
+	shift_cache_t shift; // pre-shifted glyphs and sprites
+	label_cache_t label; // rendered labels
 
 	uint8_t buff[];
 } ssd1306_int_s;
 
 
 extern const ssd1306_point_t POINT_ZERO;
+extern const uint8_t ssd1306_reverse_bits[256];
+
+void ssd1306_transpose8(const uint8_t* source, size_t s_stride, uint8_t* target, size_t t_stride);
+
+typedef void (*ssd1306_sink_t)(void* context, char c);
+
+uint16_t ssd1306_format(ssd1306_sink_t sink, void* context, const char* format, va_list args);
+
+char* ssd1306_text_formatv(ssd1306_int_t dev, const char* format, va_list args);
+ssd1306_bitmap_t* ssd1306_text_bitmap_internal(ssd1306_t device, char* text, uint16_t wrap);
+void ssd1306_text_bitmap_render(ssd1306_int_t dev, ssd1306_bitmap_t* bitmap, const char* text, bool invert);
+ssd1306_bitmap_t* ssd1306_text_lines_internal(ssd1306_t device, char* text, uint16_t width, uint16_t wrap);
+void ssd1306_text_setup(text_render_t* render, const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed);
+void ssd1306_text_render(void* context, char c);
+void ssd1306_text_glyph(text_render_t* render, uint32_t code);
+
+const ssd1306_glyph_t* ssd1306_font_find(const ssd1306_font_t* font, uint32_t code, uint16_t* hint);
+
+const shift_entry_t* ssd1306_shift_lookup(ssd1306_int_t dev, const uint8_t* image, uint8_t w, uint8_t shift);
+bool ssd1306_shift_draw(ssd1306_t device, const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
+		const ssd1306_bitmap_t* bitmap, ssd1306_rop_t rop);
+
+void* ssd1306_arena_alloc(ssd1306_int_t dev, size_t size);
+void ssd1306_arena_free(ssd1306_int_t dev, void* ptr);
+ssd1306_bitmap_t* ssd1306_arena_bitmap(ssd1306_int_t dev, ssd1306_size_t size);
 
 void ssd1306_task(ssd1306_int_t dev);
+void ssd1306_flush_internal(ssd1306_int_t dev, const ssd1306_bounds_t* bounds);
+
+void ssd1306_ticker_set(ssd1306_int_t dev, ticker_info_t* ticker, const ssd1306_bitmap_t* _Nullable bitmap);
+int64_t ssd1306_ticker_step(ssd1306_int_t dev, bool* moved);
+void ssd1306_tilemap_flush(ssd1306_int_t dev, bool* drawn);
 void ssd1306_send_buff(ssd1306_int_t dev, uint8_t ctl, const uint8_t* buff, uint16_t size);
 bool ssd1306_trim(ssd1306_t device, ssd1306_bounds_t* bounds, const ssd1306_size_t* size);
 
@@ -58,12 +214,23 @@ bool ssd1306_adjust_target_bounds(ssd1306_bounds_t* bounds,
 
 void ssd1306_update_internal(ssd1306_t device,
 		const ssd1306_bounds_t* bounds);
+void ssd1306_wake_internal(ssd1306_int_t dev);
 
 void ssd1306_clear_internal(ssd1306_t device,
 		const ssd1306_bounds_t* target);
-void ssd1306_draw_internal(ssd1306_t device, 
+void ssd1306_fill_internal(ssd1306_t device,
+		const ssd1306_bounds_t* target,
+		const ssd1306_pattern_t* pattern, ssd1306_rop_t rop);
+void ssd1306_draw_internal(ssd1306_t device,
+		const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
+		const ssd1306_bitmap_t* bitmap, const ssd1306_bitmap_t* _Nullable mask, ssd1306_rop_t rop);
+void ssd1306_draw_view_internal(ssd1306_t device,
 		const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
-		const ssd1306_bitmap_t* bitmap);
+		const ssd1306_view_t* view, const ssd1306_view_t* _Nullable mask, ssd1306_rop_t rop);
+void ssd1306_draw_page(uint8_t* buff, uint16_t width,
+		const uint8_t* s_lo, const uint8_t* s_hi, uint8_t s_bits,
+		const uint8_t* _Nullable m_lo, const uint8_t* _Nullable m_hi, uint8_t m_bits,
+		uint8_t d_mask, ssd1306_rop_t rop);
 void ssd1306_grab_internal(ssd1306_t device, 
 		const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
 		ssd1306_bitmap_t* bitmap);
@@ -81,6 +248,10 @@ inline int16_t mini(int16_t a, int16_t b)
 {
 	return a < b ? a : b;
 }
+inline int16_t maxi(int16_t a, int16_t b)
+{
+	return a > b ? a : b;
+}
 
 inline uint8_t shift_bits(uint8_t value, int8_t bits)
 {
@@ -98,11 +269,85 @@ inline uint8_t set_bits(int8_t bits)
 	}
 }
 
-inline unsigned bytes_cap(uint8_t bits)
+// bits [from, to) of a page
+inline uint8_t page_mask(uint8_t from, uint8_t to)
+{
+	return (uint8_t)((0xffu << from) & (0xffu >> (8 - to)));
+}
+
+inline unsigned bytes_cap(uint16_t bits)
 {
 	return bits / 8 + (bits % 8 ? 1 : 0);
 }
 
+// FNV-1a, to tell texts apart without keeping them
+inline uint32_t text_hash(const char* text)
+{
+	uint32_t hash = 2166136261u;
+
+	for( ; *text; text++ ) {
+		hash = (hash ^ (uint8_t)*text) * 16777619u;
+	}
+
+	return hash;
+}
+
+inline const ssd1306_glyph_t* ssd1306_font_glyphs(const ssd1306_font_t* font)
+{
+	return (const ssd1306_glyph_t*)(font->ranges + font->ranges_z);
+}
+
+// hint is the range of the previous lookup, text mostly stays within one
+inline const ssd1306_glyph_t* ssd1306_font_glyph(const ssd1306_font_t* font, uint32_t code, uint16_t* hint)
+{
+	const ssd1306_font_range_t* range = font->ranges + *hint;
+
+	if( code - range->first < range->count ) {
+		const ssd1306_glyph_t* glyph = ssd1306_font_glyphs(font) + range->glyph + (code - range->first);
+
+		return glyph->w ? glyph : NULL;
+	}
+
+	return ssd1306_font_find(font, code, hint);
+}
+
+inline const uint8_t* ssd1306_glyph_image(const ssd1306_font_t* font, const ssd1306_glyph_t* glyph)
+{
+	return (const uint8_t*)(ssd1306_font_glyphs(font) + font->glyphs_z) + glyph->offset;
+}
+
+/*
+	Feeds one byte of UTF-8, returns the code point once complete or -1
+	while more bytes are needed. Bytes which can't start a sequence stand
+	for themselves, as in Latin-1, a truncated sequence is skipped and the
+	byte cutting it short starts the next character.
+*/
+inline int32_t ssd1306_utf8_next(utf8_state_t* state, uint8_t c)
+{
+#if CONFIG_SSD1306_TEXT_UTF8
+	if( state->pending ) {
+		if( (c & 0xc0) == 0x80 ) {
+			state->code = (state->code << 6) | (c & 0x3f);
+
+			return --state->pending ? -1 : (int32_t)state->code;
+		}
+
+		state->pending = 0;
+	}
+
+	if( c < 0xc2 || c > 0xf4 ) {
+		return c;
+	}
+
+	state->pending = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : 1;
+	state->code = c & (0x3f >> state->pending);
+
+	return -1;
+#else
+	return c;
+#endif
+}
+
 inline uint16_t ssd1306_status_index(ssd1306_int_t dev, ssd1306_status_t status)
 {
 	if( status <= ssd1306_status_1 ) {
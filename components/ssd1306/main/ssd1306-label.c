@@ -0,0 +1,166 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+static label_entry_t* ssd1306_label_lookup(ssd1306_int_t dev, const char* text, uint32_t hash, bool invert);
+static label_entry_t* ssd1306_label_insert(ssd1306_int_t dev, const char* text, uint32_t hash, bool invert);
+static void ssd1306_label_evict(label_cache_t* cache, label_entry_t* entry);
+
+void ssd1306_label(ssd1306_t device, const ssd1306_bounds_t* target, bool invert, const char* format, ...)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(format);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	char* text;
+	va_list args;
+
+	va_start(args, format);
+	text = ssd1306_text_formatv(dev, format, args);
+	va_end(args);
+
+	// only to skip most of the string comparisons
+	const uint32_t hash = text_hash(text);
+	label_entry_t* entry = ssd1306_label_lookup(dev, text, hash, invert);
+	ssd1306_bitmap_t* bitmap;
+
+	if( entry ) {
+		dev->stats.label_hits++;
+
+		bitmap = (ssd1306_bitmap_t*)(dev->label.pool + entry->offset);
+	} else {
+		dev->stats.label_misses++;
+
+		entry = ssd1306_label_insert(dev, text, hash, invert);
+
+		if( entry ) {
+			bitmap = (ssd1306_bitmap_t*)(dev->label.pool + entry->offset);
+		} else {
+			// larger than the whole cache, rendered for this time only
+			bitmap = ssd1306_arena_bitmap(dev, (ssd1306_size_t){ ssd1306_text_width(device, text), device->font->height });
+		}
+
+		ssd1306_text_bitmap_render(dev, bitmap, text, invert);
+	}
+
+	ssd1306_bounds_t trimmed = *target;
+
+	if( ssd1306_trim(device, &trimmed, &bitmap->size) ) {
+		ssd1306_draw_internal(device, target, &trimmed, bitmap, NULL, ssd1306_rop_copy);
+		ssd1306_update_internal(device, &trimmed);
+	} else {
+		LOG_W("not visible");
+	}
+
+	if( entry == NULL ) {
+		ssd1306_arena_free(dev, bitmap);
+	}
+
+	ssd1306_arena_free(dev, text);
+	ssd1306_release(device);
+}
+
+label_entry_t* ssd1306_label_lookup(ssd1306_int_t dev, const char* text, uint32_t hash, bool invert)
+{
+	label_cache_t* cache = &dev->label;
+
+	for( uint8_t k = 0; k < SSD1306_LABEL_ENTRIES; k++ ) {
+		label_entry_t* entry = cache->entries + k;
+
+		if( entry->font != dev->font || entry->hash != hash || entry->invert != invert ) {
+			continue;
+		}
+
+		const ssd1306_bitmap_t* bitmap = (const ssd1306_bitmap_t*)(cache->pool + entry->offset);
+		const char* label = (const char*)(bitmap->image + bytes_cap(bitmap->h) * bitmap->w);
+
+		if( strcmp(label, text) == 0 ) {
+			entry->used = ++cache->clock;
+
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+	Makes room for the bitmap of text followed by the text itself, evicting
+	the least recently used labels. Returns NULL when it can't ever fit.
+*/
+label_entry_t* ssd1306_label_insert(ssd1306_int_t dev, const char* text, uint32_t hash, bool invert)
+{
+	label_cache_t* cache = &dev->label;
+	const ssd1306_size_t size = { ssd1306_text_width((ssd1306_t)dev, text), dev->font->height };
+	const size_t image = bytes_cap(size.h) * size.w;
+	const size_t length = sizeof(ssd1306_bitmap_t) + image + strlen(text) + 1;
+
+	if( length > cache->size ) {
+		return NULL;
+	}
+
+	while( true ) {
+		label_entry_t* slot = NULL;
+		label_entry_t* victim = NULL;
+
+		for( uint8_t k = 0; k < SSD1306_LABEL_ENTRIES; k++ ) {
+			label_entry_t* entry = cache->entries + k;
+
+			if( entry->font == NULL ) {
+				slot = entry;
+			} else if( victim == NULL || entry->used < victim->used ) {
+				victim = entry;
+			}
+		}
+
+		if( slot && cache->used + length <= cache->size ) {
+			*slot = (label_entry_t){
+				font: dev->font,
+				hash: hash,
+				used: ++cache->clock,
+				offset: cache->used,
+				length: length,
+				invert: invert,
+			};
+
+			ssd1306_bitmap_t* bitmap = (ssd1306_bitmap_t*)(cache->pool + cache->used);
+
+			memcpy((void*)&bitmap->size, &size, sizeof(size));
+			memcpy(bitmap->image + image, text, strlen(text) + 1);
+
+			cache->used += length;
+
+			return slot;
+		}
+
+		ssd1306_label_evict(cache, victim);
+	}
+}
+
+/*
+	Labels are kept packed at the start of the pool, the ones after the
+	evicted entry move down so the free space stays in one piece.
+*/
+void ssd1306_label_evict(label_cache_t* cache, label_entry_t* entry)
+{
+	const uint16_t end = entry->offset + entry->length;
+
+	memmove(cache->pool + entry->offset, cache->pool + end, cache->used - end);
+
+	for( uint8_t k = 0; k < SSD1306_LABEL_ENTRIES; k++ ) {
+		if( cache->entries[k].font && cache->entries[k].offset > entry->offset ) {
+			cache->entries[k].offset -= entry->length;
+		}
+	}
+
+	cache->used -= entry->length;
+	entry->font = NULL;
+}
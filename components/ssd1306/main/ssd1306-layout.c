@@ -0,0 +1,321 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+#include <esp_timer.h>
+
+static void ssd1306_layout_break(ssd1306_t device, ssd1306_layout_t* layout, const char* text);
+static void ssd1306_layout_draw(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_layout_t* layout, const char* text, ssd1306_align_t align);
+
+bool ssd1306_layout(ssd1306_t device, ssd1306_layout_t* layout, uint16_t width, const char* format, ...)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(layout);
+	ABORT_IF_NULL(format);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return false;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	char* text;
+	va_list args;
+
+	va_start(args, format);
+	text = ssd1306_text_formatv(dev, format, args);
+	va_end(args);
+
+	const bool changed = layout->text == NULL || layout->box_w != width || strcmp(layout->text, text) != 0;
+
+	if( changed ) {
+		const size_t length = strlen(text) + 1;
+
+		if( layout->capacity < length ) {
+			free(layout->text);
+
+			layout->text = malloc(length);
+			layout->capacity = length;
+
+			ABORT_IF(layout->text == NULL, "cannot allocate memory for layout of size %u", length);
+		}
+
+		memcpy(layout->text, text, length);
+
+		layout->box_w = width;
+
+		ssd1306_layout_break(device, layout, layout->text);
+	}
+
+	ssd1306_arena_free(dev, text);
+	ssd1306_release(device);
+
+	return changed;
+}
+
+void ssd1306_layout_free(ssd1306_layout_t* layout)
+{
+	ABORT_IF_NULL(layout);
+
+	free(layout->text);
+
+	memset(layout, 0, sizeof(ssd1306_layout_t));
+}
+
+void ssd1306_draw_layout(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_layout_t* layout, ssd1306_align_t align)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(layout);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_layout_draw(device, target, layout, layout->text, align);
+	ssd1306_release(device);
+}
+
+void ssd1306_text_box(ssd1306_t device, const ssd1306_bounds_t* target, ssd1306_align_t align,
+	const char* format, ...)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(format);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	ssd1306_layout_t layout = { box_w: ssd1306_bounds_width(target) };
+	char* text;
+	va_list args;
+
+	va_start(args, format);
+	text = ssd1306_text_formatv(dev, format, args);
+	va_end(args);
+
+	// the lines point into the arena, nothing outlives the call
+	ssd1306_layout_break(device, &layout, text);
+	ssd1306_layout_draw(device, target, &layout, text, align);
+
+	ssd1306_arena_free(dev, text);
+	ssd1306_release(device);
+}
+
+/*
+	Greedy line breaking: a line ends at the last space before the text
+	overflows the box, or before the overflowing character when there's
+	no space to break at. The spaces a line is broken at belong to no
+	line, spaces ending a paragraph aren't counted in its width.
+*/
+void ssd1306_layout_break(ssd1306_t device, ssd1306_layout_t* layout, const char* text)
+{
+	const ssd1306_font_t* font = device->font;
+	uint16_t range = 0;
+	uint16_t pos = 0;
+
+	layout->lines_z = 0;
+	layout->w = 0;
+
+	while( text[pos] && layout->lines_z < SSD1306_LAYOUT_LINES ) {
+		ssd1306_line_t* line = layout->lines + layout->lines_z++;
+		utf8_state_t utf8 = { 0 };
+		uint16_t width = 0;
+		uint16_t c_start = pos; // of the character being decoded
+		uint16_t v_end = pos; // after the last character but a space
+		uint16_t v_w = 0;
+		uint16_t b_end = pos; // the visible end before the last space
+		uint16_t b_w = 0;
+		bool breakable = false;
+
+		line->start = pos;
+
+		while( true ) {
+			const char c = text[pos];
+
+			if( c == 0 || c == '\n' ) {
+				line->length = v_end - line->start;
+				line->w = v_w;
+
+				pos += c == '\n';
+
+				break;
+			}
+
+			pos++;
+
+			const int32_t code = ssd1306_utf8_next(&utf8, c);
+
+			if( code < 0 ) {
+				continue;
+			}
+
+			// leading spaces are kept, a line can't be broken before anything shows
+			if( code == ' ' && v_end > line->start ) {
+				breakable = true;
+				b_end = v_end;
+				b_w = v_w;
+			}
+
+			const ssd1306_glyph_t* glyph = code == CONFIG_SSD1306_TEXT_INVERT
+				? NULL : ssd1306_font_glyph(font, code, &range);
+			const uint16_t advance = glyph ? glyph->w : 0;
+
+			if( width + advance > layout->box_w && c_start > line->start ) {
+				if( breakable ) {
+					line->length = b_end - line->start;
+					line->w = b_w;
+
+					pos = b_end;
+				} else {
+					line->length = c_start - line->start;
+					line->w = width;
+
+					pos = c_start;
+				}
+
+				while( text[pos] == ' ' ) {
+					pos++;
+				}
+
+				break;
+			}
+
+			width += advance;
+			c_start = pos;
+
+			if( code != ' ' ) {
+				v_end = pos;
+				v_w = width;
+			}
+		}
+
+		layout->w = maxi(layout->w, line->w);
+	}
+
+	layout->h = layout->lines_z * font->height;
+
+	LOG_D("text laid out in %u lines, %ux%u", layout->lines_z, layout->w, layout->h);
+}
+
+/*
+	All the lines are rendered into the raster while the device is held,
+	then the box goes out in a single update.
+*/
+void ssd1306_layout_draw(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_layout_t* layout, const char* text, ssd1306_align_t align)
+{
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	ssd1306_bounds_t box = *target;
+
+	if( !ssd1306_trim(device, &box, NULL) ) {
+		LOG_W("not visible");
+
+		return;
+	}
+
+	const int64_t start = esp_timer_get_time();
+	const ssd1306_font_t* font = device->font;
+	const int16_t box_w = ssd1306_bounds_width(target);
+	const int16_t box_h = ssd1306_bounds_height(target);
+
+	int16_t y = target->y0;
+
+	switch( align & 0xf0 ) {
+		case ssd1306_align_middle: y += (box_h - (int16_t)layout->h) / 2; break;
+		case ssd1306_align_bottom: y += box_h - (int16_t)layout->h; break;
+	}
+
+	text_render_t render = {
+		dev: dev,
+		font: font,
+		stride: device->w,
+	};
+
+	ssd1306_clear_internal(device, &box);
+
+	for( uint8_t k = 0; k < layout->lines_z; k++, y += font->height ) {
+		const ssd1306_line_t* line = layout->lines + k;
+		int16_t x = target->x0;
+
+		switch( align & 0x0f ) {
+			case ssd1306_align_center: x += (box_w - (int16_t)line->w) / 2; break;
+			case ssd1306_align_right: x += box_w - (int16_t)line->w; break;
+		}
+
+		const ssd1306_bounds_t bounds = { x0: x, y0: y, x1: x + line->w, y1: y + font->height };
+		ssd1306_bounds_t trimmed = bounds;
+
+		if( ssd1306_bounds_intersect(&trimmed, &box) ) {
+			render.buff = ssd1306_raster(device, trimmed.y0 >> 3);
+
+			ssd1306_text_setup(&render, &bounds, &trimmed);
+		} else {
+			// nothing shows, only the color switches carry over to the next lines
+			render.x = render.x1 = 0;
+		}
+
+		for( const char* c = text + line->start; c < text + line->start + line->length; c++ ) {
+			ssd1306_text_render(&render, *c);
+		}
+	}
+
+	dev->stats.text_chars += render.chars;
+	dev->stats.text_us += esp_timer_get_time() - start;
+
+	ssd1306_update_internal(device, &box);
+}
+
+/*
+	Renders a formatted text broken into lines of width into a bitmap from
+	the arena, the text itself is freed. Text taller than wrap gets a blank
+	line, which is where it wraps around when scrolling up or down.
+*/
+ssd1306_bitmap_t* ssd1306_text_lines_internal(ssd1306_t device, char* text, uint16_t width, uint16_t wrap)
+{
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	const ssd1306_font_t* font = device->font;
+	ssd1306_layout_t layout = { box_w: width };
+
+	ssd1306_layout_break(device, &layout, text);
+
+	const uint16_t height = layout.h + (layout.h > wrap ? font->height : 0);
+	ssd1306_bitmap_t* bitmap = ssd1306_arena_bitmap(dev, (ssd1306_size_t){ layout.w, height });
+
+	const int64_t start = esp_timer_get_time();
+
+	text_render_t render = {
+		font: font,
+		stride: layout.w,
+	};
+
+	for( uint8_t k = 0; k < layout.lines_z; k++ ) {
+		const ssd1306_line_t* line = layout.lines + k;
+		const ssd1306_bounds_t bounds = { x0: 0, y0: k * font->height, x1: line->w, y1: (k + 1) * font->height };
+
+		render.buff = bitmap->image + (bounds.y0 >> 3) * layout.w;
+
+		ssd1306_text_setup(&render, &bounds, &bounds);
+
+		for( const char* c = text + line->start; c < text + line->start + line->length; c++ ) {
+			ssd1306_text_render(&render, *c);
+		}
+	}
+
+	ssd1306_arena_free(dev, text);
+
+	dev->stats.text_chars += render.chars;
+	dev->stats.text_us += esp_timer_get_time() - start;
+
+	return bitmap;
+}
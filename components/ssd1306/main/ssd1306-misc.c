@@ -21,15 +21,23 @@ void ssd1306_fill_randomly(ssd1306_t device, const ssd1306_bounds_t* bounds)
 		return;
 	}
 
-	ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap((ssd1306_size_t){
-		ssd1306_bounds_width(&target),
-		ssd1306_bounds_height(&target)});
+	const uint16_t width = ssd1306_bounds_width(&target);
+	const int16_t t_page = target.y0 >> 3;
+	const int16_t b_page = (target.y1 - 1) >> 3;
 
-	esp_fill_random(bitmap->image, bitmap->w * bytes_cap(bitmap->h));
+	uint8_t line[CONFIG_SSD1306_WIDTH];
 
-	ssd1306_draw_internal(device, &target, &target, bitmap);
+	for( int16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t y = page * SSD1306_PAGE_HEIGHT;
+		const uint8_t d_mask = page_mask(
+			target.y0 > y ? target.y0 - y : 0,
+			target.y1 < y + 8 ? target.y1 - y : 8);
 
-	free(bitmap);
+		esp_fill_random(line, width);
+
+		ssd1306_draw_page(ssd1306_raster(device, page) + target.x0, width,
+			line, line, 0, NULL, NULL, 0, d_mask, ssd1306_rop_copy);
+	}
 
 	ssd1306_update_internal(device, &target);
 	ssd1306_release(device);
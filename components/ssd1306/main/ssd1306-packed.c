@@ -0,0 +1,109 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+static const uint8_t* packed_page(const ssd1306_packed_t* packed, uint16_t page);
+static void unpack_page(const uint8_t* stream, uint16_t c0, uint16_t c1, uint8_t* target);
+
+void ssd1306_draw_packed(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_packed_t* packed, ssd1306_rop_t rop)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(packed);
+
+	ssd1306_bounds_t trimmed = *target;
+
+	if( !ssd1306_trim(device, &trimmed, &packed->size) ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	const uint16_t c0 = trimmed.x0 - target->x0;
+	const uint16_t c1 = trimmed.x1 - target->x0;
+	const uint16_t t_page = (trimmed.y0 - target->y0) / 8;
+	const uint16_t b_page = (trimmed.y1 - target->y0 - 1) / 8;
+
+	LOG_D("unpacking columns [%u, %u) of pages [%u, %u]", c0, c1, t_page, b_page);
+
+	uint8_t line[CONFIG_SSD1306_WIDTH];
+
+	for( uint16_t page = t_page; page <= b_page; page++ ) {
+		unpack_page(packed_page(packed, page), c0, c1, line);
+
+		const ssd1306_view_t view = {
+			w: c1 - c0, h: minu(8, packed->h - page * 8),
+			stride: c1 - c0,
+			image: line,
+		};
+		const ssd1306_bounds_t bounds = {
+			x0: trimmed.x0, y0: target->y0 + page * 8,
+			x1: trimmed.x1, y1: target->y0 + page * 8 + view.h,
+		};
+		ssd1306_bounds_t visible = bounds;
+
+		if( ssd1306_bounds_intersect(&visible, &trimmed) ) {
+			ssd1306_draw_view_internal(device, &bounds, &visible, &view, NULL, rop);
+		}
+	}
+
+	ssd1306_update_internal(device, &trimmed);
+	ssd1306_release(device);
+}
+
+ssd1306_bitmap_t* ssd1306_unpack(const ssd1306_packed_t* packed)
+{
+	ABORT_IF_NULL(packed);
+
+	ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap(packed->size);
+
+	for( uint16_t page = 0; page < bytes_cap(packed->h); page++ ) {
+		unpack_page(packed_page(packed, page), 0, packed->w, bitmap->image + page * packed->w);
+	}
+
+	return bitmap;
+}
+
+const uint8_t* packed_page(const ssd1306_packed_t* packed, uint16_t page)
+{
+	const uint16_t pages = bytes_cap(packed->h);
+	const uint16_t offset = packed->data[2 * page] | packed->data[2 * page + 1] << 8;
+
+	return packed->data + 2 * pages + offset;
+}
+
+/*
+	Run-length encoding of our own, PackBits-like but not compatible with
+	it: a control byte c < 128 is followed by c + 1 literal bytes,
+	otherwise the next byte is repeated c - 126 times. Only columns
+	[c0, c1) are kept, and decoding stops as soon as c1 is reached.
+*/
+void unpack_page(const uint8_t* stream, uint16_t c0, uint16_t c1, uint8_t* target)
+{
+	uint16_t x = 0;
+
+	while( x < c1 ) {
+		const uint8_t control = *stream++;
+		const bool literal = control < 128;
+		const uint16_t count = literal ? control + 1 : control - 126;
+
+		const uint16_t from = x > c0 ? x : c0;
+		const uint16_t to = minu(x + count, c1);
+
+		if( from < to ) {
+			if( literal ) {
+				memcpy(target + from - c0, stream + from - x, to - from);
+			} else {
+				memset(target + from - c0, *stream, to - from);
+			}
+		}
+
+		stream += literal ? count : 1;
+		x += count;
+	}
+}
@@ -0,0 +1,213 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+#include <esp_timer.h>
+
+typedef struct scaled_render_t {
+	ssd1306_t device;
+	const ssd1306_font_t* font;
+	const ssd1306_bounds_t* clip; // the visible part of the text
+	int16_t x; // where the next glyph goes
+	int16_t y;
+	uint8_t scale;
+	bool invert;
+	utf8_state_t utf8;
+	uint16_t range;
+	uint16_t chars;
+} scaled_render_t;
+
+static void ssd1306_scale_image(ssd1306_t device, int16_t x, int16_t y, const ssd1306_bounds_t* clip,
+	const uint8_t* image, uint16_t w, uint16_t h, uint8_t scale, uint8_t flip, ssd1306_rop_t rop);
+static void ssd1306_scaled_render(void* context, char c);
+
+// each bit of a nibble repeated n times, for the scales 2 to 4
+static const uint16_t spread_nibble[SSD1306_SCALE_MAX - 1][16] = {
+	{
+		0x0000, 0x0003, 0x000c, 0x000f, 0x0030, 0x0033, 0x003c, 0x003f,
+		0x00c0, 0x00c3, 0x00cc, 0x00cf, 0x00f0, 0x00f3, 0x00fc, 0x00ff,
+	},
+	{
+		0x0000, 0x0007, 0x0038, 0x003f, 0x01c0, 0x01c7, 0x01f8, 0x01ff,
+		0x0e00, 0x0e07, 0x0e38, 0x0e3f, 0x0fc0, 0x0fc7, 0x0ff8, 0x0fff,
+	},
+	{
+		0x0000, 0x000f, 0x00f0, 0x00ff, 0x0f00, 0x0f0f, 0x0ff0, 0x0fff,
+		0xf000, 0xf00f, 0xf0f0, 0xf0ff, 0xff00, 0xff0f, 0xfff0, 0xffff,
+	},
+};
+
+static inline uint32_t spread_byte(uint8_t value, uint8_t scale)
+{
+	if( scale == 1 ) {
+		return value;
+	}
+
+	const uint16_t* lut = spread_nibble[scale - 2];
+
+	return lut[value & 0x0f] | (uint32_t)lut[value >> 4] << (4 * scale);
+}
+
+void ssd1306_draw_scaled(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_bitmap_t* bitmap, uint8_t scale, ssd1306_rop_t rop)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(bitmap);
+	ABORT_IF(scale == 0 || scale > SSD1306_SCALE_MAX, "invalid scale %u", scale);
+
+	const ssd1306_size_t size = { bitmap->w * scale, bitmap->h * scale };
+	ssd1306_bounds_t trimmed = *target;
+
+	if( !ssd1306_trim(device, &trimmed, &size) ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_scale_image(device, target->x0, target->y0, &trimmed,
+		bitmap->image, bitmap->w, bitmap->h, scale, 0x00, rop);
+
+	ssd1306_update_internal(device, &trimmed);
+	ssd1306_release(device);
+}
+
+void ssd1306_text_scaled(ssd1306_t device, const ssd1306_bounds_t* target, uint8_t scale, const char* format, ...)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(format);
+	ABORT_IF(scale == 0 || scale > SSD1306_SCALE_MAX, "invalid scale %u", scale);
+
+	const ssd1306_size_t size = { ssd1306_bounds_width(target), device->font->height * scale };
+	ssd1306_bounds_t trimmed = *target;
+
+	if( !ssd1306_trim(device, &trimmed, &size) ) {
+		LOG_W("not visible");
+
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	const int64_t start = esp_timer_get_time();
+
+	scaled_render_t render = {
+		device: device,
+		font: device->font,
+		clip: &trimmed,
+		x: target->x0,
+		y: target->y0,
+		scale: scale,
+	};
+	va_list args;
+
+	// glyphs are expanded into the raster as they're formatted
+	va_start(args, format);
+	ssd1306_format(ssd1306_scaled_render, &render, format, args);
+	va_end(args);
+
+	dev->stats.text_chars += render.chars;
+	dev->stats.text_us += esp_timer_get_time() - start;
+
+	trimmed.x1 = mini(trimmed.x1, render.x);
+
+	if( trimmed.x1 > trimmed.x0 ) {
+		ssd1306_update_internal(device, &trimmed);
+	}
+
+	ssd1306_release(device);
+}
+
+void ssd1306_scaled_render(void* context, char c)
+{
+	scaled_render_t* render = context;
+	const int32_t code = ssd1306_utf8_next(&render->utf8, c);
+
+	if( code < 0 ) {
+		return;
+	}
+
+	render->chars++;
+
+	if( code == CONFIG_SSD1306_TEXT_INVERT ) {
+		render->invert = !render->invert;
+
+		return;
+	}
+	if( render->x >= render->clip->x1 ) {
+		return;
+	}
+
+	const ssd1306_glyph_t* glyph = ssd1306_font_glyph(render->font, code, &render->range);
+
+	if( glyph == NULL ) {
+		return;
+	}
+
+	ssd1306_scale_image(render->device, render->x, render->y, render->clip,
+		ssd1306_glyph_image(render->font, glyph), glyph->w, render->font->height,
+		render->scale, render->invert ? 0xff : 0x00, ssd1306_rop_copy);
+
+	render->x += glyph->w * render->scale;
+}
+
+/*
+	Draws a page-major image of w x h scaled at (x, y), within clip only.
+	Each target page is gathered column by column from the spread bytes
+	of the one or two source pages it overlaps, a source column giving
+	scale target columns, then goes through the raster operation.
+*/
+void ssd1306_scale_image(ssd1306_t device, int16_t x, int16_t y, const ssd1306_bounds_t* clip,
+	const uint8_t* image, uint16_t w, uint16_t h, uint8_t scale, uint8_t flip, ssd1306_rop_t rop)
+{
+	const ssd1306_bounds_t bounds = { x0: x, y0: y, x1: x + w * scale, y1: y + h * scale };
+	ssd1306_bounds_t trimmed = bounds;
+
+	if( !ssd1306_bounds_intersect(&trimmed, clip) ) {
+		return;
+	}
+
+	const int16_t s_pages = bytes_cap(h);
+	const uint8_t span = SSD1306_PAGE_HEIGHT * scale; // target rows of one source page
+	const int16_t t_page = trimmed.y0 >> 3;
+	const int16_t b_page = (trimmed.y1 - 1) >> 3;
+	const uint16_t width = trimmed.x1 - trimmed.x0;
+
+	uint8_t line[CONFIG_SSD1306_WIDTH];
+
+	for( int16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t py = page * SSD1306_PAGE_HEIGHT;
+
+		// the scaled row landing on bit 0 of this page, at most a page above the image
+		const int16_t row = py - y;
+		const int16_t s_page = row < 0 ? -1 : row / span;
+		const uint8_t s_bits = row - s_page * span;
+
+		const uint8_t mask = page_mask(maxi(0, trimmed.y0 - py), mini(SSD1306_PAGE_HEIGHT, trimmed.y1 - py));
+
+		for( int16_t k = trimmed.x0; k < trimmed.x1; ) {
+			const uint16_t column = (k - x) / scale;
+			const uint8_t* source = image + column;
+
+			const uint64_t lo = (s_page >= 0 && s_page < s_pages) ? spread_byte(source[s_page * w], scale) : 0;
+			const uint64_t hi = (s_page + 1 < s_pages) ? spread_byte(source[(s_page + 1) * w], scale) : 0;
+			const uint8_t bits = (uint8_t)((lo | hi << span) >> s_bits) ^ flip;
+
+			for( const int16_t end = mini(trimmed.x1, x + (column + 1) * scale); k < end; k++ ) {
+				line[k - trimmed.x0] = bits;
+			}
+		}
+
+		ssd1306_draw_page(ssd1306_raster(device, page) + trimmed.x0, width,
+			line, line, 0, NULL, NULL, 0, mask, rop);
+	}
+}
@@ -0,0 +1,116 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+static void ssd1306_scroll_page(ssd1306_t device, const ssd1306_bounds_t* bounds,
+	int16_t page, int16_t dx, int16_t dy, uint8_t fill);
+
+void ssd1306_scroll(ssd1306_t device, const ssd1306_bounds_t* target, int16_t dx, int16_t dy, bool fill)
+{
+	ABORT_IF_NULL(device);
+
+	ssd1306_bounds_t d_bounds;
+
+	if( !ssd1306_adjust_target_bounds(&d_bounds, device, target) ) {
+		return;
+	}
+	if( dx == 0 && dy == 0 ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	const int16_t t_page = d_bounds.y0 >> 3;
+	const int16_t b_page = (d_bounds.y1 - 1) >> 3;
+	const uint8_t fill_byte = fill ? 0xff : 0x00;
+
+	LOG_D("t_page = %d, b_page = %d, dx = %+d, dy = %+d", t_page, b_page, dx, dy);
+
+	// moving down reads the pages above, so start from the bottom
+	if( dy > 0 ) {
+		for( int16_t page = b_page; page >= t_page; page-- ) {
+			ssd1306_scroll_page(device, &d_bounds, page, dx, dy, fill_byte);
+		}
+	} else {
+		for( int16_t page = t_page; page <= b_page; page++ ) {
+			ssd1306_scroll_page(device, &d_bounds, page, dx, dy, fill_byte);
+		}
+	}
+
+	ssd1306_update_internal(device, &d_bounds);
+	ssd1306_release(device);
+}
+
+/*
+	Every pixel (x, y) of the page takes the value of (x - dx, y - dy),
+	or the fill value when that one is outside of the bounds. Columns are
+	walked against the direction of the move, so sources are always read
+	before being overwritten.
+*/
+void ssd1306_scroll_page(ssd1306_t device, const ssd1306_bounds_t* bounds,
+	int16_t page, int16_t dx, int16_t dy, uint8_t fill)
+{
+	const int16_t y = page * SSD1306_PAGE_HEIGHT;
+	const uint16_t width = ssd1306_bounds_width(bounds);
+
+	const uint8_t d_mask = page_mask(
+		bounds->y0 > y ? bounds->y0 - y : 0,
+		bounds->y1 < y + 8 ? bounds->y1 - y : 8);
+
+	uint8_t* buff = ssd1306_raster(device, page) + bounds->x0;
+
+	// the source columns, relative to bounds->x0, that stay within bounds
+	const int16_t c0 = dx > 0 ? dx : 0;
+	const int16_t c1 = dx < 0 ? width + dx : width;
+
+	if( dy == 0 && d_mask == 0xff ) {
+		LOG_T("page %d, move %d bytes", page, c1 - c0);
+
+		if( c0 < c1 ) {
+			memmove(buff + c0, buff + c0 - dx, c1 - c0);
+		} else {
+			memset(buff, fill, width);
+
+			return;
+		}
+
+		memset(dx > 0 ? buff : buff + c1, fill, abs(dx));
+
+		return;
+	}
+
+	// the source row landing on bit 0 of this page and its valid bits
+	const int16_t row = y - dy;
+	const int16_t s_page = row >> 3;
+	const uint8_t s_bits = row & 7;
+
+	const uint8_t s_mask = page_mask(
+		bounds->y0 > row ? minu(bounds->y0 - row, 8) : 0,
+		bounds->y1 < row + 8 ? (bounds->y1 > row ? bounds->y1 - row : 0) : 8);
+
+	const uint8_t* s_lo = s_page >= 0 && s_page < device->pages ? ssd1306_raster(device, s_page) + bounds->x0 : NULL;
+	const uint8_t* s_hi = s_page + 1 >= 0 && s_page + 1 < device->pages ? ssd1306_raster(device, s_page + 1) + bounds->x0 : NULL;
+
+	LOG_T("page %d, d_mask = 0x%02x, s_page = %d, s_bits = %u, s_mask = 0x%02x", page, d_mask, s_page, s_bits, s_mask);
+
+	for( int16_t k = 0; k < width; k++ ) {
+		const int16_t x = dx > 0 ? width - 1 - k : k;
+		const int16_t s_x = x - dx;
+
+		uint8_t value = fill;
+
+		if( s_x >= 0 && s_x < width && s_mask ) {
+			const uint8_t lo = s_lo ? s_lo[s_x] : 0;
+			const uint8_t hi = s_hi ? s_hi[s_x] : 0;
+			const uint8_t bits = (uint8_t)(lo >> s_bits) | (uint8_t)(hi << (8 - s_bits));
+
+			value = (bits & s_mask) | (fill & ~s_mask);
+		}
+
+		buff[x] = (buff[x] & ~d_mask) | (value & d_mask);
+	}
+}
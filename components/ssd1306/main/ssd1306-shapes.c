@@ -0,0 +1,406 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+typedef struct shape_t {
+	ssd1306_t device;
+	ssd1306_bounds_t clip; // the visible part of the primitive
+	ssd1306_color_t color;
+} shape_t;
+
+static bool shape_begin(shape_t* shape, ssd1306_t device, const ssd1306_bounds_t* bounds, ssd1306_color_t color);
+static void shape_end(shape_t* shape);
+
+static void shape_hspan(const shape_t* shape, int16_t x0, int16_t x1, int16_t y);
+static void shape_vspan(const shape_t* shape, int16_t x, int16_t y0, int16_t y1);
+static void shape_line(const shape_t* shape, ssd1306_point_t p0, ssd1306_point_t p1, bool last);
+
+static const ssd1306_pattern_t pattern_ones = { image: { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+
+void ssd1306_pixel(ssd1306_t device, ssd1306_point_t point, ssd1306_color_t color)
+{
+	ssd1306_pixels(device, &point, 1, color);
+}
+
+void ssd1306_pixels(ssd1306_t device, const ssd1306_point_t* points, size_t count, ssd1306_color_t color)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(points);
+
+	if( count == 0 ) {
+		return;
+	}
+
+	ssd1306_bounds_t bounds = { x0: INT16_MAX, y0: INT16_MAX, x1: INT16_MIN, y1: INT16_MIN };
+
+	for( size_t k = 0; k < count; k++ ) {
+		bounds.x0 = mini(bounds.x0, points[k].x);
+		bounds.y0 = mini(bounds.y0, points[k].y);
+		bounds.x1 = maxi(bounds.x1, points[k].x + 1);
+		bounds.y1 = maxi(bounds.y1, points[k].y + 1);
+	}
+
+	shape_t shape;
+
+	if( !shape_begin(&shape, device, &bounds, color) ) {
+		return;
+	}
+
+	for( size_t k = 0; k < count; k++ ) {
+		shape_hspan(&shape, points[k].x, points[k].x + 1, points[k].y);
+	}
+
+	shape_end(&shape);
+}
+
+void ssd1306_line(ssd1306_t device, ssd1306_point_t p0, ssd1306_point_t p1, ssd1306_color_t color)
+{
+	ABORT_IF_NULL(device);
+
+	const ssd1306_bounds_t bounds = {
+		x0: mini(p0.x, p1.x), y0: mini(p0.y, p1.y),
+		x1: maxi(p0.x, p1.x) + 1, y1: maxi(p0.y, p1.y) + 1,
+	};
+
+	shape_t shape;
+
+	if( !shape_begin(&shape, device, &bounds, color) ) {
+		return;
+	}
+
+	shape_line(&shape, p0, p1, true);
+	shape_end(&shape);
+}
+
+void ssd1306_rect(ssd1306_t device, const ssd1306_bounds_t* bounds, bool filled, ssd1306_color_t color)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(bounds);
+
+	shape_t shape;
+
+	if( !shape_begin(&shape, device, bounds, color) ) {
+		return;
+	}
+
+	if( filled ) {
+		static const ssd1306_rop_t rops[] = {
+			[ssd1306_color_clear]  = ssd1306_rop_and_not,
+			[ssd1306_color_set]    = ssd1306_rop_or,
+			[ssd1306_color_invert] = ssd1306_rop_xor,
+		};
+
+		ssd1306_fill_internal(device, &shape.clip, &pattern_ones, rops[color]);
+	} else {
+		shape_hspan(&shape, bounds->x0, bounds->x1, bounds->y0);
+
+		if( bounds->y1 - bounds->y0 > 1 ) {
+			shape_hspan(&shape, bounds->x0, bounds->x1, bounds->y1 - 1);
+		}
+		if( bounds->y1 - bounds->y0 > 2 ) {
+			shape_vspan(&shape, bounds->x0, bounds->y0 + 1, bounds->y1 - 1);
+
+			if( bounds->x1 - bounds->x0 > 1 ) {
+				shape_vspan(&shape, bounds->x1 - 1, bounds->y0 + 1, bounds->y1 - 1);
+			}
+		}
+	}
+
+	shape_end(&shape);
+}
+
+void ssd1306_circle(ssd1306_t device, ssd1306_point_t center, uint16_t r, bool filled, ssd1306_color_t color)
+{
+	ssd1306_ellipse(device, center, r, r, filled, color);
+}
+
+/*
+	Rows are walked from the top of the lower half towards the centre line;
+	the half width w of each row is the largest x with
+		x²·ry² + y²·rx² <= rx²·ry² + rx·ry·(rx + ry)/2
+	which, for a circle, is x² + y² <= r² + r. An outline row covers the
+	columns between its own half width and the one of the row outside it,
+	so every pixel is touched exactly once and inverting works.
+*/
+void ssd1306_ellipse(ssd1306_t device, ssd1306_point_t center, uint16_t rx, uint16_t ry,
+	bool filled, ssd1306_color_t color)
+{
+	ABORT_IF_NULL(device);
+
+	const ssd1306_bounds_t bounds = {
+		x0: center.x - rx, y0: center.y - ry,
+		x1: center.x + rx + 1, y1: center.y + ry + 1,
+	};
+
+	shape_t shape;
+
+	if( !shape_begin(&shape, device, &bounds, color) ) {
+		return;
+	}
+
+	const int64_t rx2 = (int64_t)rx * rx;
+	const int64_t ry2 = (int64_t)ry * ry;
+	const int64_t limit = rx2 * ry2 + (int64_t)rx * ry * (rx + ry) / 2;
+
+	int16_t w = 0;
+	int16_t w_out = -1;
+
+	for( int16_t dy = ry; dy >= 0; dy-- ) {
+		while( w < rx && (int64_t)(w + 1) * (w + 1) * ry2 + (int64_t)dy * dy * rx2 <= limit ) {
+			w++;
+		}
+
+		const int16_t lo = filled ? 0 : mini(w_out + 1, w);
+
+		for( int16_t y = center.y - dy; y <= center.y + dy; y += 2 * dy ) {
+			if( lo == 0 ) {
+				shape_hspan(&shape, center.x - w, center.x + w + 1, y);
+			} else {
+				shape_hspan(&shape, center.x - w, center.x - lo + 1, y);
+				shape_hspan(&shape, center.x + lo, center.x + w + 1, y);
+			}
+
+			if( dy == 0 ) {
+				break;
+			}
+		}
+
+		w_out = w;
+	}
+
+	shape_end(&shape);
+}
+
+/*
+	The filled polygon covers the pixels whose centre lies inside, using
+	the even-odd rule; edges are sampled at integer rows in 16.16 fixed
+	point, top and left edges inclusive.
+*/
+void ssd1306_polygon(ssd1306_t device, const ssd1306_point_t* points, size_t count,
+	bool filled, ssd1306_color_t color)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(points);
+
+	if( count == 0 ) {
+		return;
+	}
+	if( filled && count > SSD1306_POLYGON_MAX ) {
+		LOG_W("Too many vertices: %u, at most %u", (unsigned)count, SSD1306_POLYGON_MAX);
+
+		return;
+	}
+
+	ssd1306_bounds_t bounds = { x0: INT16_MAX, y0: INT16_MAX, x1: INT16_MIN, y1: INT16_MIN };
+
+	for( size_t k = 0; k < count; k++ ) {
+		bounds.x0 = mini(bounds.x0, points[k].x);
+		bounds.y0 = mini(bounds.y0, points[k].y);
+		bounds.x1 = maxi(bounds.x1, points[k].x + 1);
+		bounds.y1 = maxi(bounds.y1, points[k].y + 1);
+	}
+
+	shape_t shape;
+
+	if( !shape_begin(&shape, device, &bounds, color) ) {
+		return;
+	}
+
+	if( !filled ) {
+		if( count <= 2 ) {
+			shape_line(&shape, points[0], points[count - 1], true);
+		} else {
+			for( size_t k = 0; k < count; k++ ) {
+				shape_line(&shape, points[k], points[(k + 1) % count], false);
+			}
+		}
+
+		shape_end(&shape);
+
+		return;
+	}
+
+	int32_t xs[SSD1306_POLYGON_MAX];
+
+	for( int16_t y = shape.clip.y0; y < shape.clip.y1; y++ ) {
+		unsigned n = 0;
+
+		for( size_t k = 0; k < count; k++ ) {
+			ssd1306_point_t a = points[k];
+			ssd1306_point_t b = points[(k + 1) % count];
+
+			if( a.y > b.y ) {
+				const ssd1306_point_t t = a;
+
+				a = b;
+				b = t;
+			}
+			if( y < a.y || y >= b.y ) {
+				continue;
+			}
+
+			int32_t x = (int32_t)a.x * 65536 + (int32_t)((int64_t)(y - a.y) * (b.x - a.x) * 65536 / (b.y - a.y));
+			unsigned j = n++;
+
+			for( ; j > 0 && xs[j - 1] > x; j-- ) {
+				xs[j] = xs[j - 1];
+			}
+
+			xs[j] = x;
+		}
+
+		for( unsigned k = 0; k + 1 < n; k += 2 ) {
+			shape_hspan(&shape, (xs[k] + 0xffff) >> 16, (xs[k + 1] + 0xffff) >> 16, y);
+		}
+	}
+
+	shape_end(&shape);
+}
+
+bool shape_begin(shape_t* shape, ssd1306_t device, const ssd1306_bounds_t* bounds, ssd1306_color_t color)
+{
+	ABORT_IF(color > ssd1306_color_invert, "invalid color %d", color);
+
+	shape->device = device;
+	shape->color = color;
+
+	if( !ssd1306_adjust_target_bounds(&shape->clip, device, bounds) ) {
+		return false;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return false;
+	}
+
+	return true;
+}
+
+void shape_end(shape_t* shape)
+{
+	ssd1306_update_internal(shape->device, &shape->clip);
+	ssd1306_release(shape->device);
+}
+
+/*
+	Columns [x0, x1) of row y, a single bit within each byte.
+*/
+void shape_hspan(const shape_t* shape, int16_t x0, int16_t x1, int16_t y)
+{
+	if( y < shape->clip.y0 || y >= shape->clip.y1 ) {
+		return;
+	}
+
+	x0 = maxi(x0, shape->clip.x0);
+	x1 = mini(x1, shape->clip.x1);
+
+	if( x0 >= x1 ) {
+		return;
+	}
+
+	uint8_t* buff = ssd1306_raster(shape->device, y >> 3);
+	const uint8_t mask = 1 << (y & 7);
+
+	switch( shape->color ) {
+		case ssd1306_color_clear:
+			for( int16_t x = x0; x < x1; x++ ) {
+				buff[x] &= ~mask;
+			}
+		break;
+		case ssd1306_color_set:
+			for( int16_t x = x0; x < x1; x++ ) {
+				buff[x] |= mask;
+			}
+		break;
+		case ssd1306_color_invert:
+			for( int16_t x = x0; x < x1; x++ ) {
+				buff[x] ^= mask;
+			}
+		break;
+	}
+}
+
+/*
+	Rows [y0, y1) of column x, a single byte within each page.
+*/
+void shape_vspan(const shape_t* shape, int16_t x, int16_t y0, int16_t y1)
+{
+	if( x < shape->clip.x0 || x >= shape->clip.x1 ) {
+		return;
+	}
+
+	y0 = maxi(y0, shape->clip.y0);
+	y1 = mini(y1, shape->clip.y1);
+
+	for( int16_t page = y0 >> 3; y0 < y1; page++ ) {
+		const int16_t y = page * SSD1306_PAGE_HEIGHT;
+		const uint8_t mask = page_mask(y0 - y, mini(y1 - y, 8));
+		uint8_t* buff = ssd1306_raster(shape->device, page) + x;
+
+		switch( shape->color ) {
+			case ssd1306_color_clear:  *buff &= ~mask; break;
+			case ssd1306_color_set:    *buff |= mask; break;
+			case ssd1306_color_invert: *buff ^= mask; break;
+		}
+
+		y0 = y + SSD1306_PAGE_HEIGHT;
+	}
+}
+
+/*
+	Bresenham, emitting each run of pixels along the major axis as a single
+	span. The last point is left out when drawing connected segments.
+*/
+void shape_line(const shape_t* shape, ssd1306_point_t p0, ssd1306_point_t p1, bool last)
+{
+	const int16_t dx = abs(p1.x - p0.x);
+	const int16_t dy = abs(p1.y - p0.y);
+	const int16_t sx = p0.x < p1.x ? 1 : -1;
+	const int16_t sy = p0.y < p1.y ? 1 : -1;
+
+	int16_t x = p0.x;
+	int16_t y = p0.y;
+
+	if( dx >= dy ) {
+		const int16_t count = dx + (last ? 1 : 0);
+		int32_t err = 2 * dy - dx;
+		int16_t start = x;
+
+		for( int16_t k = 0; k < count; k++ ) {
+			const bool next_row = err > 0;
+
+			if( next_row || k == count - 1 ) {
+				shape_hspan(shape, mini(start, x), maxi(start, x) + 1, y);
+				start = x + sx;
+			}
+			if( next_row ) {
+				y += sy;
+				err -= 2 * dx;
+			}
+
+			err += 2 * dy;
+			x += sx;
+		}
+	} else {
+		const int16_t count = dy + (last ? 1 : 0);
+		int32_t err = 2 * dx - dy;
+		int16_t start = y;
+
+		for( int16_t k = 0; k < count; k++ ) {
+			const bool next_column = err > 0;
+
+			if( next_column || k == count - 1 ) {
+				shape_vspan(shape, x, mini(start, y), maxi(start, y) + 1);
+				start = y + sy;
+			}
+			if( next_column ) {
+				x += sx;
+				err -= 2 * dy;
+			}
+
+			err += 2 * dx;
+			y += sy;
+		}
+	}
+}
@@ -0,0 +1,185 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+static shift_entry_t* shift_set(ssd1306_int_t dev, const uint8_t* image, uint8_t shift);
+
+bool ssd1306_register_sprite(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(bitmap);
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+
+	if( dev->shift.size == 0 || bitmap->h > SSD1306_PAGE_HEIGHT || bitmap->w > SSD1306_SHIFT_WIDTH ) {
+		LOG_D("bitmap of %ux%u won't be cached", bitmap->w, bitmap->h);
+
+		return false;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return false;
+	}
+
+	int8_t slot = -1;
+
+	for( uint8_t k = 0; k < SSD1306_SPRITES_MAX; k++ ) {
+		if( dev->shift.sprites[k] == bitmap ) {
+			slot = k;
+
+			break;
+		}
+		if( slot < 0 && dev->shift.sprites[k] == NULL ) {
+			slot = k;
+		}
+	}
+
+	if( slot >= 0 ) {
+		dev->shift.sprites[slot] = bitmap;
+	} else {
+		LOG_W("no room for another sprite");
+	}
+
+	ssd1306_release(device);
+
+	return slot >= 0;
+}
+
+void ssd1306_unregister_sprite(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(bitmap);
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	for( uint8_t k = 0; k < SSD1306_SPRITES_MAX; k++ ) {
+		if( dev->shift.sprites[k] == bitmap ) {
+			dev->shift.sprites[k] = NULL;
+		}
+	}
+
+	// the memory might be reused for another image
+	for( uint16_t k = 0; k < dev->shift.size; k++ ) {
+		if( dev->shift.entries[k].image == bitmap->image ) {
+			dev->shift.entries[k].image = NULL;
+		}
+	}
+
+	ssd1306_release(device);
+}
+
+/*
+	Returns the image shifted down by shift rows, split into the part
+	landing in the top page and the one spilling into the next. Entries
+	are keyed by the image address, which is why only constant images,
+	glyphs and registered sprites, may be looked up.
+*/
+const shift_entry_t* ssd1306_shift_lookup(ssd1306_int_t dev, const uint8_t* image, uint8_t w, uint8_t shift)
+{
+	if( dev->shift.size == 0 || w > SSD1306_SHIFT_WIDTH ) {
+		return NULL;
+	}
+
+	shift_entry_t* set = shift_set(dev, image, shift);
+	shift_entry_t* victim = set;
+
+	dev->shift.clock++;
+
+	for( uint8_t k = 0; k < SSD1306_SHIFT_WAYS; k++ ) {
+		shift_entry_t* entry = set + k;
+
+		if( entry->image == image && entry->shift == shift && entry->w == w ) {
+			entry->used = dev->shift.clock;
+
+			dev->stats.shift_hits++;
+
+			return entry;
+		}
+
+		if( entry->image == NULL ) {
+			victim = entry;
+		} else if( victim->image && entry->used < victim->used ) {
+			victim = entry;
+		}
+	}
+
+	dev->stats.shift_misses++;
+
+	victim->image = image;
+	victim->w = w;
+	victim->shift = shift;
+	victim->used = dev->shift.clock;
+
+	for( uint8_t x = 0; x < w; x++ ) {
+		victim->lo[x] = image[x] << shift;
+		victim->hi[x] = image[x] >> (8 - shift);
+	}
+
+	return victim;
+}
+
+/*
+	A registered sprite at an unaligned row becomes two masked stores of
+	its cached halves, returns false when the bitmap doesn't qualify.
+*/
+bool ssd1306_shift_draw(ssd1306_t device, const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed,
+	const ssd1306_bitmap_t* bitmap, ssd1306_rop_t rop)
+{
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	const uint8_t shift = bounds->y0 & 7;
+
+	if( shift == 0 || dev->shift.size == 0 ) {
+		return false;
+	}
+
+	bool registered = false;
+
+	for( uint8_t k = 0; k < SSD1306_SPRITES_MAX && !registered; k++ ) {
+		registered = dev->shift.sprites[k] == bitmap;
+	}
+
+	if( !registered ) {
+		return false;
+	}
+
+	const shift_entry_t* entry = ssd1306_shift_lookup(dev, bitmap->image, bitmap->w, shift);
+	const uint16_t s_offset = trimmed->x0 - bounds->x0;
+	const uint16_t width = ssd1306_bounds_width(trimmed);
+
+	const int16_t page = bounds->y0 >> 3;
+
+	for( uint8_t k = 0; k < 2; k++ ) {
+		const int16_t y = (page + k) * SSD1306_PAGE_HEIGHT;
+
+		// the trimmed rows within this page, never more than the sprite covers
+		const int16_t from = maxi(0, trimmed->y0 - y);
+		const int16_t to = mini(SSD1306_PAGE_HEIGHT, trimmed->y1 - y);
+
+		if( from >= to ) {
+			continue;
+		}
+
+		const uint8_t* source = (k ? entry->hi : entry->lo) + s_offset;
+
+		ssd1306_draw_page(ssd1306_raster(device, page + k) + trimmed->x0, width,
+			source, source, 0, NULL, NULL, 0, page_mask(from, to), rop);
+	}
+
+	return true;
+}
+
+shift_entry_t* shift_set(ssd1306_int_t dev, const uint8_t* image, uint8_t shift)
+{
+	// neighbouring glyphs and their shifts spread over different sets
+	const uint32_t hash = ((uint32_t)(uintptr_t)image + shift) * 2654435761u >> 16;
+
+	return dev->shift.entries + (hash % (dev->shift.size / SSD1306_SHIFT_WAYS)) * SSD1306_SHIFT_WAYS;
+}
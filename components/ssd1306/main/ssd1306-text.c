@@ -3,9 +3,15 @@
 
 #include "ssd1306-int.h"
 
+#include <esp_timer.h>
+
+typedef struct text_buffer_t {
+	char* text;
+	uint16_t length;
+} text_buffer_t;
+
 static void ssd1306_text_internal(ssd1306_t device, const ssd1306_bounds_t* bounds, const char* format, va_list args);
-static ssd1306_bitmap_t* ssd1306_text_bitmapv(ssd1306_t device, const char* format, va_list args);
-static char* ssd1306_text_formatv(uint16_t* length, const char* format, va_list args);
+static void ssd1306_text_append(void* context, char c);
 
 static const char TEXT_SEPA[] = " \x4 ";
 static const unsigned TEXT_SEPA_Z = 3;
@@ -22,43 +28,45 @@ void ssd1306_status(ssd1306_t device, ssd1306_status_t status, const char* forma
 	const uint16_t index = ssd1306_status_index(dev, status);
 	status_info_t* si = &dev->statuses[index];
 
-	if( si->bitmap ) {
-		free(si->bitmap);
-
-		si->bitmap = NULL;
-	}
-
 	const ssd1306_bounds_t* bounds = (ssd1306_bounds_t*)si;
 
 	LOG_D("status info at index %u(%u)", index, status);
 	LOG_BOUNDS_D("              bounds", bounds);
 
-	ssd1306_clear_internal(device, bounds);
+	char* text = NULL;
 
 	if( format ) {
-		ssd1306_bitmap_t* bitmap;
 		va_list args;
 
 		va_start(args, format);
-		bitmap = ssd1306_text_bitmapv(device, format, args);
+		text = ssd1306_text_formatv(dev, format, args);
 		va_end(args);
+	}
 
-		ssd1306_bounds_t trimmed = *bounds;
+	const uint32_t hash = text ? text_hash(text) : 0;
 
-		ssd1306_trim(device, &trimmed, &bitmap->size);
-		ssd1306_draw_internal(device, bounds, &trimmed, bitmap);
+	// called again with the same text, the status is left alone, scrolling or not
+	if( si->valid && si->hash == hash ) {
+		LOG_T("status text unchanged");
 
-		if( bitmap->w > device->w ) {
-			si->bitmap = bitmap;
-			si->state = anim_init;
+		ssd1306_arena_free(dev, text);
+		ssd1306_release(device);
 
-			LOG_D("text will scroll in background");
-		} else {
-			free(bitmap);
-		}
+		return;
+	}
+
+	if( text ) {
+		ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap_internal(device, text, device->w);
+
+		ssd1306_ticker_set(dev, &si->ticker, bitmap);
+		ssd1306_arena_free(dev, bitmap);
+	} else {
+		ssd1306_ticker_set(dev, &si->ticker, NULL);
 	}
 
-	ssd1306_update_internal(device, bounds);
+	si->valid = true;
+	si->hash = hash;
+
 	ssd1306_release(device);
 }
 
@@ -89,14 +97,20 @@ uint16_t ssd1306_text_width(ssd1306_t device, const char* text)
 	ABORT_IF_NULL(device);
 	ABORT_IF_NULL(text);
 
+	utf8_state_t utf8 = { 0 };
+	uint16_t range = 0;
 	uint16_t width = 0;
 
 	for( ; *text; text++ ) {
-		if( *text == CONFIG_SSD1306_TEXT_INVERT ) {
+		const int32_t code = ssd1306_utf8_next(&utf8, *text);
+
+		if( code < 0 || code == CONFIG_SSD1306_TEXT_INVERT ) {
 			continue;
 		}
 
-		width += device->font[(uint8_t)(*text)].w;
+		const ssd1306_glyph_t* glyph = ssd1306_font_glyph(device->font, code, &range);
+
+		width += glyph ? glyph->w : 0;
 	}
 
 	return width;
@@ -107,101 +121,259 @@ ssd1306_bitmap_t* ssd1306_text_bitmap(ssd1306_t device, const char* format, ...)
 	ABORT_IF_NULL(device);
 	ABORT_IF_NULL(format);
 
-	ssd1306_bitmap_t* bitmap;
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return NULL;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	ssd1306_bitmap_t* scratch;
 	va_list args;
 
 	va_start(args, format);
-	bitmap = ssd1306_text_bitmapv(device, format, args);
+	scratch = ssd1306_text_bitmap_internal(device, ssd1306_text_formatv(dev, format, args), device->w);
 	va_end(args);
 
+	// the caller owns the result, that one comes from the heap
+	ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap(scratch->size);
+
+	memcpy(bitmap->image, scratch->image, bytes_cap(scratch->h) * scratch->w);
+
+	ssd1306_arena_free(dev, scratch);
+	ssd1306_release(device);
+
 	return bitmap;
 }
 
 void ssd1306_text_internal(ssd1306_t device, const ssd1306_bounds_t* bounds, const char* format, va_list args)
 {
-	ssd1306_bitmap_t* bitmap = ssd1306_text_bitmapv(device, format, args);
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	const ssd1306_size_t size = { ssd1306_bounds_width(bounds), device->font->height };
 	ssd1306_bounds_t trimmed = *bounds;
 
-	if( !ssd1306_trim(device, &trimmed, &bitmap->size) ) {
+	if( ssd1306_trim(device, &trimmed, &size) ) {
+		text_render_t render = {
+			dev: (ssd1306_int_t)device,
+			font: device->font,
+			buff: ssd1306_raster(device, trimmed.y0 >> 3),
+			stride: device->w,
+		};
+
+		ssd1306_int_t dev = (ssd1306_int_t)device;
+		const int64_t start = esp_timer_get_time();
+
+		ssd1306_text_setup(&render, bounds, &trimmed);
+
+		// formatted characters are drawn as they come, nothing is buffered
+		ssd1306_format(ssd1306_text_render, &render, format, args);
+
+		dev->stats.text_chars += render.chars;
+		dev->stats.text_us += esp_timer_get_time() - start;
+
+		// only what the text covered needs an update
+		trimmed.x1 = mini(trimmed.x1, render.x);
+
+		if( trimmed.x1 > trimmed.x0 ) {
+			ssd1306_update_internal(device, &trimmed);
+		}
+	} else {
 		LOG_W("not visible");
+	}
 
-		free(bitmap);
+	ssd1306_release(device);
+}
 
-		return;
+/*
+	Works out the pages and rows written for text laid out at bounds,
+	of which only trimmed is visible.
+*/
+void ssd1306_text_setup(text_render_t* render, const ssd1306_bounds_t* bounds, const ssd1306_bounds_t* trimmed)
+{
+	const int16_t t_page = trimmed->y0 >> 3;
+	const int16_t b_page = (trimmed->y1 - 1) >> 3;
+
+	render->pages = b_page - t_page + 1;
+	render->shift = bounds->y0 - t_page * SSD1306_PAGE_HEIGHT;
+	render->x = bounds->x0;
+	render->x0 = trimmed->x0;
+	render->x1 = trimmed->x1;
+
+	for( uint8_t page = 0; page < render->pages; page++ ) {
+		const int16_t y = (t_page + page) * SSD1306_PAGE_HEIGHT;
+
+		render->masks[page] = page_mask(maxi(0, trimmed->y0 - y), mini(SSD1306_PAGE_HEIGHT, trimmed->y1 - y));
 	}
-	if( !ssd1306_acquire(device) ) {
-		free(bitmap);
 
-		LOG_W("couldn't take mutex");
+	LOG_D("rendering into %u pages from %d, shift = %d", render->pages, t_page, render->shift);
+}
 
+static inline void store_bits(uint8_t* buff, uint8_t mask, uint8_t bits)
+{
+	*buff = (*buff & ~mask) | (bits & mask);
+}
+
+void ssd1306_text_render(void* context, char c)
+{
+	text_render_t* render = context;
+	const int32_t code = ssd1306_utf8_next(&render->utf8, c);
+
+	if( code < 0 ) {
 		return;
 	}
 
-	ssd1306_draw_internal(device, bounds, &trimmed, bitmap);
-
-	free(bitmap);
+	render->chars++;
 
-	ssd1306_update_internal(device, &trimmed);
-	ssd1306_release(device);
+	if( code == CONFIG_SSD1306_TEXT_INVERT ) {
+		render->invert = !render->invert;
+	} else {
+		ssd1306_text_glyph(render, code);
+	}
 }
 
-ssd1306_bitmap_t* ssd1306_text_bitmapv(ssd1306_t device, const char* format, va_list args)
+/*
+	Writes the glyph of code straight into the pages of the text row, each
+	column page by page, skipping the columns outside the visible ones.
+	Characters outside of the font are skipped.
+*/
+void ssd1306_text_glyph(text_render_t* render, uint32_t code)
 {
-	uint16_t length;
-	char* text = ssd1306_text_formatv(&length, format, args);
+	if( render->x >= render->x1 ) {
+		return;
+	}
 
-	uint16_t width = ssd1306_text_width(device, text);
+	const ssd1306_glyph_t* glyph = ssd1306_font_glyph(render->font, code, &render->range);
 
-	if( width > device->w ) {
-		length += TEXT_SEPA_Z;
+	if( glyph == NULL ) {
+		return;
+	}
 
-		strcat(text, TEXT_SEPA);
+	const uint8_t* image = ssd1306_glyph_image(render->font, glyph);
+	const int16_t g_pages = bytes_cap(render->font->height);
+	const int16_t x = render->x;
+	const int16_t from = maxi(x, render->x0);
+	const int16_t to = mini(x + glyph->w, render->x1);
+	const int8_t shift = render->shift;
+	const uint8_t flip = render->invert ? 0xff : 0x00;
 
-		width = ssd1306_text_width(device, text);
+	render->x += glyph->w;
+
+	const shift_entry_t* entry = (g_pages == 1 && shift > 0 && render->dev)
+		? ssd1306_shift_lookup(render->dev, image, glyph->w, shift) : NULL;
+
+	if( entry ) {
+		// inverting the shifted halves is the same within the masks
+		for( int16_t k = from; k < to; k++ ) {
+			store_bits(render->buff + k, render->masks[0], entry->lo[k - x] ^ flip);
+
+			if( render->pages > 1 ) {
+				store_bits(render->buff + render->stride + k, render->masks[1], entry->hi[k - x] ^ flip);
+			}
+		}
+
+		return;
 	}
 
-	ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap((ssd1306_size_t){ width, SSD1306_TEXT_HEIGHT });
+	for( int16_t k = from; k < to; k++ ) {
+		const uint8_t* column = image + (k - x);
 
-	bool invert = false;
+		for( uint8_t page = 0; page < render->pages; page++ ) {
+			// the glyph row landing on bit 0 of this page, might be negative
+			const int16_t row = page * SSD1306_PAGE_HEIGHT - shift;
+			const int16_t s_page = row >> 3;
+			const uint8_t s_bits = row & 7;
 
-	for( uint16_t index = 0, offset = 0; index < length && offset < width; index++ ) {
-		if( text[index] == CONFIG_SSD1306_TEXT_INVERT ) {
-			invert = !invert;
+			const uint8_t lo = (s_page >= 0 && s_page < g_pages) ? column[s_page * glyph->w] ^ flip : 0;
+			const uint8_t hi = (s_page + 1 >= 0 && s_page + 1 < g_pages) ? column[(s_page + 1) * glyph->w] ^ flip : 0;
+			const uint8_t bits = s_bits ? (lo >> s_bits) | (hi << (8 - s_bits)) : lo;
 
-			continue;
+			store_bits(render->buff + page * render->stride + k, render->masks[page], bits);
 		}
+	}
+}
 
-		const uint16_t cpos = text[index];
-		const ssd1306_glyph_t* glyph = device->font + cpos;
+void ssd1306_text_append(void* context, char c)
+{
+	text_buffer_t* buffer = context;
 
-		if( invert ) {
-			for( int k = 0; k < glyph->w; k++ ) {
-				bitmap->image[offset + k] = ~glyph->image[k];
-			}
-		} else {
-			memcpy(bitmap->image + offset, glyph->image, glyph->w);
-		}
+	if( buffer->length < SSD1306_TEXT_LENGTH ) {
+		buffer->text[buffer->length++] = c;
+	}
+}
+
+/*
+	Formats into the arena, for when the text has to be measured before
+	it's drawn. There's room left for the status separator.
+*/
+char* ssd1306_text_formatv(ssd1306_int_t dev, const char* format, va_list args)
+{
+	text_buffer_t buffer = {
+		text: ssd1306_arena_alloc(dev, SSD1306_TEXT_LENGTH + TEXT_SEPA_Z + 1),
+	};
+
+	ssd1306_format(ssd1306_text_append, &buffer, format, args);
+
+	buffer.text[buffer.length] = 0;
+
+	LOG_D("text formatted as \"%s\"", buffer.text);
 
-		offset += glyph->w;
+	return buffer.text;
+}
+
+/*
+	Renders a formatted text into a bitmap from the arena, the text itself
+	is freed. Text wider than wrap gets the status separator, which is
+	where it wraps around when scrolling.
+*/
+ssd1306_bitmap_t* ssd1306_text_bitmap_internal(ssd1306_t device, char* text, uint16_t wrap)
+{
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+
+	uint16_t width = ssd1306_text_width(device, text);
+
+	if( width > wrap ) {
+		strcat(text, TEXT_SEPA);
+
+		width = ssd1306_text_width(device, text);
 	}
 
-	free(text);
+	ssd1306_bitmap_t* bitmap = ssd1306_arena_bitmap(dev, (ssd1306_size_t){ width, device->font->height });
+
+	ssd1306_text_bitmap_render(dev, bitmap, text, false);
+	ssd1306_arena_free(dev, text);
 
 	return bitmap;
 }
 
-char* ssd1306_text_formatv(uint16_t* length, const char* format, va_list args)
+/*
+	Renders text into a bitmap of its width and the height of the font,
+	the previous content is cleared.
+*/
+void ssd1306_text_bitmap_render(ssd1306_int_t dev, ssd1306_bitmap_t* bitmap, const char* text, bool invert)
 {
-	uint16_t needed = vsnprintf(NULL, 0, format, args) + 1;
-	char* text = malloc(needed + TEXT_SEPA_Z);
+	const int64_t start = esp_timer_get_time();
+	const ssd1306_bounds_t bounds = { x1: bitmap->w, y1: bitmap->h };
 
-	ABORT_IF(text == NULL, "cannot allocate memory for text of size %u", needed);
+	text_render_t render = {
+		font: dev->font,
+		buff: bitmap->image,
+		stride: bitmap->w,
+		invert: invert,
+	};
 
-	vsnprintf(text, needed, format, args);
+	memset(bitmap->image, 0, bytes_cap(bitmap->h) * bitmap->w);
 
-	LOG_D("text formatted as \"%s\"", text);
+	ssd1306_text_setup(&render, &bounds, &bounds);
 
-	*length = needed;
+	for( const char* c = text; *c; c++ ) {
+		ssd1306_text_render(&render, *c);
+	}
 
-	return text;
+	dev->stats.text_chars += render.chars;
+	dev->stats.text_us += esp_timer_get_time() - start;
 }
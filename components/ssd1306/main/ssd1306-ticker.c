@@ -0,0 +1,284 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+#include <esp_timer.h>
+
+static void ssd1306_ticker_keep(ticker_info_t* ticker, const ssd1306_bitmap_t* bitmap);
+static void ssd1306_ticker_show(ssd1306_int_t dev, const ticker_info_t* ticker);
+static void ssd1306_ticker_stop(ssd1306_int_t dev, ticker_info_t* ticker);
+
+static inline bool is_vertical(const ticker_info_t* ticker)
+{
+	return ticker->config.direction >= ssd1306_ticker_up;
+}
+
+static inline uint16_t ticker_period(const ticker_info_t* ticker)
+{
+	return is_vertical(ticker) ? ticker->content->h : ticker->content->w;
+}
+
+ssd1306_ticker_t ssd1306_create_ticker(ssd1306_t device, const ssd1306_bounds_t* bounds,
+	const ssd1306_ticker_config_t* config)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(bounds);
+	ABORT_IF_NULL(config);
+	ABORT_IF(config->direction > ssd1306_ticker_down, "invalid direction %u", config->direction);
+
+	ticker_info_t* ticker = calloc(1, sizeof(ticker_info_t));
+
+	ABORT_IF(ticker == NULL, "cannot allocate memory for ticker");
+
+	ticker->bounds = *bounds;
+	ticker->config = *config;
+
+	return ticker;
+}
+
+void ssd1306_free_ticker(ssd1306_t device, ssd1306_ticker_t ticker)
+{
+	ABORT_IF_NULL(device);
+
+	if( ticker == NULL ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_ticker_stop((ssd1306_int_t)device, ticker);
+	ssd1306_release(device);
+
+	free(ticker->content);
+	free(ticker);
+}
+
+void ssd1306_ticker_bitmap(ssd1306_t device, ssd1306_ticker_t ticker, const ssd1306_bitmap_t* bitmap)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(ticker);
+	ABORT_IF_NULL(bitmap);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_ticker_set((ssd1306_int_t)device, ticker, bitmap);
+	ssd1306_release(device);
+}
+
+void ssd1306_ticker_text(ssd1306_t device, ssd1306_ticker_t ticker, const char* format, ...)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(ticker);
+	ABORT_IF_NULL(format);
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	const uint16_t band_w = ssd1306_bounds_width(&ticker->bounds);
+	char* text;
+	va_list args;
+
+	va_start(args, format);
+	text = ssd1306_text_formatv(dev, format, args);
+	va_end(args);
+
+	// moving up or down, the text is broken into lines as wide as the band
+	ssd1306_bitmap_t* bitmap = is_vertical(ticker)
+		? ssd1306_text_lines_internal(device, text, band_w, ssd1306_bounds_height(&ticker->bounds))
+		: ssd1306_text_bitmap_internal(device, text, band_w);
+
+	ssd1306_ticker_set(dev, ticker, bitmap);
+
+	ssd1306_arena_free(dev, bitmap);
+	ssd1306_release(device);
+}
+
+/*
+	Shows new content, or blanks the ticker when bitmap is NULL. Content of
+	the same size as the one moving is swapped in at the current position,
+	otherwise the ticker starts over, or stays still when the content fits.
+*/
+void ssd1306_ticker_set(ssd1306_int_t dev, ticker_info_t* ticker, const ssd1306_bitmap_t* bitmap)
+{
+	const ssd1306_bitmap_t* content = ticker->content;
+
+	if( bitmap && ticker->running && bitmap->w == content->w && bitmap->h == content->h ) {
+		const size_t length = bytes_cap(bitmap->h) * bitmap->w;
+
+		if( memcmp(content->image, bitmap->image, length) == 0 ) {
+			return;
+		}
+
+		memcpy(ticker->content->image, bitmap->image, length);
+
+		LOG_D("ticker content replaced");
+	} else if( bitmap ) {
+		ssd1306_ticker_keep(ticker, bitmap);
+
+		const uint16_t extent = is_vertical(ticker)
+			? ssd1306_bounds_height(&ticker->bounds) : ssd1306_bounds_width(&ticker->bounds);
+
+		ticker->position = 0;
+
+		if( ticker_period(ticker) > extent && ticker->config.speed ) {
+			// as after each round, the first step follows the pause by an interval
+			ticker->next_us = esp_timer_get_time() + ticker->config.pause_ms * 1000LL + 1000000 / ticker->config.speed;
+
+			if( !ticker->running ) {
+				ticker->running = true;
+				ticker->next = dev->tickers;
+
+				dev->tickers = ticker;
+			}
+
+			LOG_D("ticker will scroll in background");
+		} else {
+			ssd1306_ticker_stop(dev, ticker);
+		}
+	} else {
+		ssd1306_ticker_stop(dev, ticker);
+
+		if( ticker->content ) {
+			// still kept for its memory, but nothing to show
+			memset((void*)&ticker->content->size, 0, sizeof(ssd1306_size_t));
+		}
+	}
+
+	ssd1306_ticker_show(dev, ticker);
+	ssd1306_update_internal((ssd1306_t)dev, &ticker->bounds);
+}
+
+/*
+	Moves every running ticker which is due by a pixel and flushes its
+	band alone. Returns the time until the next step is due, -1 when no
+	ticker runs.
+*/
+int64_t ssd1306_ticker_step(ssd1306_int_t dev, bool* moved)
+{
+	const int64_t now = esp_timer_get_time();
+	int64_t wait = -1;
+
+	for( ticker_info_t* ticker = dev->tickers; ticker; ticker = ticker->next ) {
+		if( now >= ticker->next_us ) {
+			const int64_t interval = 1000000 / ticker->config.speed;
+
+			if( ++ticker->position >= ticker_period(ticker) ) {
+				ticker->position = 0;
+			}
+
+			const int64_t delay = ticker->position ? interval : interval + ticker->config.pause_ms * 1000LL;
+
+			// keep the pace unless a whole step has been missed
+			ticker->next_us = now - ticker->next_us < interval ? ticker->next_us + delay : now + delay;
+
+			ssd1306_ticker_show(dev, ticker);
+
+#if CONFIG_SSD1306_OPTIMIZE
+			ssd1306_flush_internal(dev, &ticker->bounds);
+#endif
+			*moved = true;
+		}
+
+		if( wait < 0 || ticker->next_us - now < wait ) {
+			wait = ticker->next_us - now;
+		}
+	}
+
+	return wait;
+}
+
+void ssd1306_ticker_stop(ssd1306_int_t dev, ticker_info_t* ticker)
+{
+	if( !ticker->running ) {
+		return;
+	}
+
+	for( ticker_info_t** link = &dev->tickers; *link; link = &(*link)->next ) {
+		if( *link == ticker ) {
+			*link = ticker->next;
+
+			break;
+		}
+	}
+
+	ticker->running = false;
+	ticker->next = NULL;
+}
+
+/*
+	Copies the content out of the arena or the caller's memory, reusing
+	the previous allocation when large enough.
+*/
+void ssd1306_ticker_keep(ticker_info_t* ticker, const ssd1306_bitmap_t* bitmap)
+{
+	const size_t length = sizeof(ssd1306_bitmap_t) + bytes_cap(bitmap->h) * bitmap->w;
+
+	if( ticker->capacity < length ) {
+		free(ticker->content);
+
+		ticker->content = malloc(length);
+		ticker->capacity = length;
+
+		ABORT_IF(ticker->content == NULL, "cannot allocate memory for ticker of size %u", length);
+	}
+
+	memcpy(ticker->content, bitmap, length);
+}
+
+/*
+	Draws the content moved by position, repeated as often as it takes to
+	fill the band when running. Tickers are drawn at full intensity, into
+	both planes in grayscale mode.
+*/
+void ssd1306_ticker_show(ssd1306_int_t dev, const ticker_info_t* ticker)
+{
+	const ssd1306_t device = (ssd1306_t)dev;
+	ssd1306_bounds_t band = ticker->bounds;
+
+	if( !ssd1306_trim(device, &band, NULL) ) {
+		return;
+	}
+
+	const ssd1306_bitmap_t* content = ticker->content;
+	const bool vertical = is_vertical(ticker);
+	const int16_t period = content ? ticker_period(ticker) : 0;
+	const int16_t start = vertical ? ticker->bounds.y0 : ticker->bounds.x0;
+	const int16_t end = ticker->running ? (vertical ? ticker->bounds.y1 : ticker->bounds.x1) : start + 1;
+
+	// moving right or down, the copy before the band comes in
+	const int16_t shift = (ticker->config.direction == ssd1306_ticker_left || ticker->config.direction == ssd1306_ticker_up)
+		? ticker->position : (period - ticker->position) % maxi(period, 1);
+
+	uint8_t* const raster = dev->raster;
+
+	for( uint8_t plane = 0; plane < (dev->grayscale ? 2 : 1); plane++ ) {
+		dev->raster = dev->planes[plane];
+
+		ssd1306_clear_internal(device, &band);
+
+		for( int16_t at = start - shift; period > 0 && at < end; at += period ) {
+			const ssd1306_bounds_t bounds = vertical
+				? (ssd1306_bounds_t){ x0: ticker->bounds.x0, y0: at, x1: ticker->bounds.x0 + content->w, y1: at + content->h }
+				: (ssd1306_bounds_t){ x0: at, y0: ticker->bounds.y0, x1: at + content->w, y1: ticker->bounds.y0 + content->h };
+			ssd1306_bounds_t trimmed = bounds;
+
+			if( ssd1306_bounds_intersect(&trimmed, &band) ) {
+				ssd1306_draw_internal(device, &bounds, &trimmed, content, NULL, ssd1306_rop_copy);
+			}
+		}
+	}
+
+	dev->raster = raster;
+}
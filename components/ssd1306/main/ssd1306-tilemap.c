@@ -0,0 +1,275 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+static void ssd1306_tilemap_pend(ssd1306_int_t dev, tilemap_info_t* map);
+static void ssd1306_tilemap_compose(ssd1306_int_t dev, const tilemap_info_t* map, const ssd1306_bounds_t* region);
+
+static inline int16_t wrap(int16_t value, int16_t size)
+{
+	return ((value % size) + size) % size;
+}
+
+ssd1306_tilemap_t ssd1306_create_tilemap(ssd1306_t device, const ssd1306_bounds_t* bounds,
+	uint8_t cols, uint8_t rows, const uint8_t* atlas, uint16_t tiles)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(bounds);
+	ABORT_IF_NULL(atlas);
+	ABORT_IF(bounds->y0 % SSD1306_PAGE_HEIGHT, "tile map at row %d, not on a page boundary", bounds->y0);
+	ABORT_IF(cols == 0 || rows == 0 || tiles == 0, "empty tile map %ux%u of %u tiles", cols, rows, tiles);
+
+	const uint16_t cells = cols * rows;
+	const uint16_t words = (cells + 31) / 32;
+
+	tilemap_info_t* map = calloc(1, sizeof(tilemap_info_t) + ((cells + 3) & ~3) + words * sizeof(uint32_t));
+
+	ABORT_IF(map == NULL, "cannot allocate memory for tile map of %ux%u", cols, rows);
+
+	map->bounds = *bounds;
+	map->atlas = atlas;
+	map->tiles = tiles;
+	map->cols = cols;
+	map->rows = rows;
+	map->full = true;
+
+	// the dirty bits go after the cells, aligned
+	map->dirty = (uint32_t*)(map->cells + ((cells + 3) & ~3));
+
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		free(map);
+
+		return NULL;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+
+	map->next = dev->tilemaps;
+	dev->tilemaps = map;
+
+	ssd1306_tilemap_pend(dev, map);
+	ssd1306_release(device);
+
+	return map;
+}
+
+void ssd1306_free_tilemap(ssd1306_t device, ssd1306_tilemap_t map)
+{
+	ABORT_IF_NULL(device);
+
+	if( map == NULL ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+
+	for( tilemap_info_t** link = &dev->tilemaps; *link; link = &(*link)->next ) {
+		if( *link == map ) {
+			*link = map->next;
+
+			break;
+		}
+	}
+
+	ssd1306_release(device);
+
+	free(map);
+}
+
+void ssd1306_tilemap_set(ssd1306_t device, ssd1306_tilemap_t map, uint8_t col, uint8_t row, uint8_t tile)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(map);
+	ABORT_IF(col >= map->cols || row >= map->rows, "cell %u,%u outside of the %ux%u tile map", col, row, map->cols, map->rows);
+	ABORT_IF(tile >= map->tiles, "tile %u outside of the atlas of %u", tile, map->tiles);
+
+	const uint16_t cell = row * map->cols + col;
+
+	if( map->cells[cell] == tile ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	map->cells[cell] = tile;
+	map->dirty[cell / 32] |= 1u << (cell % 32);
+
+	ssd1306_tilemap_pend((ssd1306_int_t)device, map);
+	ssd1306_release(device);
+}
+
+void ssd1306_tilemap_scroll(ssd1306_t device, ssd1306_tilemap_t map, int16_t x, int16_t y)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(map);
+
+	const ssd1306_point_t scroll = {
+		x: wrap(x, map->cols * SSD1306_TILE_SIZE),
+		y: wrap(y, map->rows * SSD1306_TILE_SIZE),
+	};
+
+	if( scroll.x == map->scroll.x && scroll.y == map->scroll.y ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("couldn't take mutex");
+
+		return;
+	}
+
+	// nothing moves until the task composites the region
+	map->scroll = scroll;
+	map->full = true;
+
+	ssd1306_tilemap_pend((ssd1306_int_t)device, map);
+	ssd1306_release(device);
+}
+
+/*
+	Composites the tile maps which changed into the raster and flushes
+	each changed cell on its own. A scrolled map, or one repeated in its
+	region, is composited and flushed as a whole.
+*/
+void ssd1306_tilemap_flush(ssd1306_int_t dev, bool* drawn)
+{
+	for( tilemap_info_t* map = dev->tilemaps; map; map = map->next ) {
+		if( !map->pending ) {
+			continue;
+		}
+
+		const uint16_t cells = map->cols * map->rows;
+		const bool direct = map->scroll.x == 0 && map->scroll.y == 0
+			&& ssd1306_bounds_width(&map->bounds) <= map->cols * SSD1306_TILE_SIZE
+			&& ssd1306_bounds_height(&map->bounds) <= map->rows * SSD1306_TILE_SIZE;
+
+		if( map->full || !direct ) {
+			ssd1306_bounds_t region = map->bounds;
+
+			ssd1306_tilemap_compose(dev, map, &region);
+
+#if CONFIG_SSD1306_OPTIMIZE
+			if( ssd1306_trim((ssd1306_t)dev, &region, NULL) ) {
+				ssd1306_flush_internal(dev, &region);
+			}
+#endif
+		} else {
+			for( uint16_t cell = 0; cell < cells; cell++ ) {
+				if( (map->dirty[cell / 32] & (1u << (cell % 32))) == 0 ) {
+					continue;
+				}
+
+				const int16_t x = map->bounds.x0 + (cell % map->cols) * SSD1306_TILE_SIZE;
+				const int16_t y = map->bounds.y0 + (cell / map->cols) * SSD1306_TILE_SIZE;
+
+				ssd1306_bounds_t region = { x0: x, y0: y, x1: x + SSD1306_TILE_SIZE, y1: y + SSD1306_TILE_SIZE };
+
+				if( !ssd1306_bounds_intersect(&region, &map->bounds) ) {
+					continue;
+				}
+
+				ssd1306_tilemap_compose(dev, map, &region);
+
+#if CONFIG_SSD1306_OPTIMIZE
+				if( ssd1306_trim((ssd1306_t)dev, &region, NULL) ) {
+					ssd1306_flush_internal(dev, &region);
+				}
+#endif
+			}
+		}
+
+		memset(map->dirty, 0, (cells + 31) / 32 * sizeof(uint32_t));
+
+		map->full = false;
+		map->pending = false;
+
+		*drawn = true;
+	}
+}
+
+/*
+	The task is woken once per map until it composites it, further changes
+	are picked up along.
+*/
+void ssd1306_tilemap_pend(ssd1306_int_t dev, tilemap_info_t* map)
+{
+	if( map->pending ) {
+		return;
+	}
+
+	map->pending = true;
+
+	if( dev->defer_update == 0 ) {
+		ssd1306_wake_internal(dev);
+	}
+}
+
+static inline void store_bits(uint8_t* buff, uint8_t mask, uint8_t bits)
+{
+	*buff = (*buff & ~mask) | (bits & mask);
+}
+
+/*
+	Writes the map into region, which is within its bounds. Unscrolled
+	rows copy whole tiles, 8 bytes of a page each, scrolled ones put
+	every column together from the two tile rows it overlaps. Tile maps
+	are drawn at full intensity, into both planes in grayscale mode.
+*/
+void ssd1306_tilemap_compose(ssd1306_int_t dev, const tilemap_info_t* map, const ssd1306_bounds_t* region)
+{
+	ssd1306_bounds_t trimmed = *region;
+
+	if( !ssd1306_trim((ssd1306_t)dev, &trimmed, NULL) ) {
+		return;
+	}
+
+	const int16_t map_w = map->cols * SSD1306_TILE_SIZE;
+	const int16_t map_h = map->rows * SSD1306_TILE_SIZE;
+	const int16_t t_page = trimmed.y0 >> 3;
+	const int16_t b_page = (trimmed.y1 - 1) >> 3;
+
+	for( int16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t py = page * SSD1306_PAGE_HEIGHT;
+		const uint8_t mask = page_mask(maxi(0, trimmed.y0 - py), mini(SSD1306_PAGE_HEIGHT, trimmed.y1 - py));
+
+		// the map row landing on bit 0 of this page
+		const int16_t my = wrap(py - map->bounds.y0 + map->scroll.y, map_h);
+		const uint8_t s_bits = my & 7;
+		const uint8_t* lo_row = map->cells + (my >> 3) * map->cols;
+		const uint8_t* hi_row = map->cells + ((my >> 3) + 1) % map->rows * map->cols;
+
+		for( uint8_t plane = 0; plane < (dev->grayscale ? 2 : 1); plane++ ) {
+			uint8_t* buff = dev->planes[plane] + page * dev->w;
+
+			for( int16_t x = trimmed.x0; x < trimmed.x1; ) {
+				const int16_t mx = wrap(x - map->bounds.x0 + map->scroll.x, map_w);
+				const uint8_t* lo = map->atlas + lo_row[mx >> 3] * SSD1306_TILE_SIZE;
+
+				if( s_bits == 0 && mask == 0xff && (mx & 7) == 0 && x + SSD1306_TILE_SIZE <= trimmed.x1 ) {
+					memcpy(buff + x, lo, SSD1306_TILE_SIZE);
+
+					x += SSD1306_TILE_SIZE;
+
+					continue;
+				}
+
+				const uint8_t* hi = map->atlas + hi_row[mx >> 3] * SSD1306_TILE_SIZE;
+				const uint8_t bits = s_bits ? (lo[mx & 7] >> s_bits) | (hi[mx & 7] << (8 - s_bits)) : lo[mx & 7];
+
+				store_bits(buff + x, mask, bits);
+
+				x++;
+			}
+		}
+	}
+}
@@ -0,0 +1,157 @@
+#include <sdkconfig.h>
+#include <ssd1306.h>
+
+#include "ssd1306-int.h"
+
+static void transform_line(const ssd1306_view_t* view, ssd1306_transform_t transform,
+	int16_t u0, int16_t v0, uint16_t width, uint8_t* line);
+
+static inline bool is_rotation(ssd1306_transform_t transform)
+{
+	return transform == ssd1306_transform_rotate_90 || transform == ssd1306_transform_rotate_270;
+}
+
+// 8 rows starting with row of the given column, zero outside of the view
+static inline uint8_t fetch_column(const ssd1306_view_t* view, int16_t column, int16_t row)
+{
+	if( column < 0 || column >= view->w ) {
+		return 0;
+	}
+
+	row += view->shift;
+
+	const int16_t page = row >> 3;
+	const uint8_t bits = row & 7;
+	const int16_t pages = bytes_cap(view->shift + view->h);
+	const uint8_t* data = view->image + column;
+
+	const uint8_t lo = page >= 0 && page < pages ? data[page * view->stride] : 0;
+	const uint8_t hi = page + 1 >= 0 && page + 1 < pages ? data[(page + 1) * view->stride] : 0;
+
+	return (uint8_t)(lo >> bits) | (uint8_t)(hi << (8 - bits));
+}
+
+ssd1306_size_t ssd1306_transform_size(ssd1306_size_t size, ssd1306_transform_t transform)
+{
+	return is_rotation(transform) ? (ssd1306_size_t){ size.h, size.w } : size;
+}
+
+void ssd1306_draw_transformed(ssd1306_t device, const ssd1306_bounds_t* target,
+	const ssd1306_view_t* view, const ssd1306_view_t* mask,
+	ssd1306_transform_t transform, ssd1306_rop_t rop)
+{
+	ABORT_IF_NULL(device);
+	ABORT_IF_NULL(target);
+	ABORT_IF_NULL(view);
+	ABORT_IF(mask && (mask->w != view->w || mask->h != view->h),
+		"mask of %ux%u doesn't match view of %ux%u", mask->w, mask->h, view->w, view->h);
+
+	const ssd1306_size_t size = ssd1306_transform_size(view->size, transform);
+	ssd1306_bounds_t trimmed = *target;
+
+	if( !ssd1306_trim(device, &trimmed, &size) ) {
+		return;
+	}
+	if( !ssd1306_acquire(device) ) {
+		LOG_W("Couldn't take mutex");
+
+		return;
+	}
+
+	const uint16_t trimmed_w = ssd1306_bounds_width(&trimmed);
+	const int16_t u0 = trimmed.x0 - target->x0;
+
+	const int16_t t_page = trimmed.y0 >> 3;
+	const int16_t b_page = (trimmed.y1 - 1) >> 3;
+
+	LOG_D("t_page = %d, b_page = %d, transform = %d, rop = %d", t_page, b_page, transform, rop);
+
+	for( int16_t page = t_page; page <= b_page; page++ ) {
+		const int16_t y = page * SSD1306_PAGE_HEIGHT;
+
+		const uint8_t d_mask = page_mask(
+			trimmed.y0 > y ? trimmed.y0 - y : 0,
+			trimmed.y1 < y + 8 ? trimmed.y1 - y : 8);
+
+		uint8_t s_line[CONFIG_SSD1306_WIDTH];
+		uint8_t m_line[CONFIG_SSD1306_WIDTH];
+
+		transform_line(view, transform, u0, y - target->y0, trimmed_w, s_line);
+
+		if( mask ) {
+			transform_line(mask, transform, u0, y - target->y0, trimmed_w, m_line);
+		}
+
+		ssd1306_draw_page(ssd1306_raster(device, page) + trimmed.x0, trimmed_w,
+			s_line, s_line, 0,
+			mask ? m_line : NULL, m_line, 0, d_mask, rop);
+	}
+
+	ssd1306_update_internal(device, &trimmed);
+	ssd1306_release(device);
+}
+
+/*
+	Fill a line with the transformed pixels of columns [u0, u0 + width)
+	and rows [v0, v0 + 8) of the transformed image. Mirrors read columns
+	backwards and reverse the bits of 8 rows ending at the mirrored row,
+	rotations gather 8 columns of the view and transpose them.
+*/
+void transform_line(const ssd1306_view_t* view, ssd1306_transform_t transform,
+	int16_t u0, int16_t v0, uint16_t width, uint8_t* line)
+{
+	const int16_t w = view->w;
+	const int16_t h = view->h;
+
+	switch( transform ) {
+		case ssd1306_transform_none:
+			for( unsigned x = 0; x < width; x++ ) {
+				line[x] = fetch_column(view, u0 + x, v0);
+			}
+		break;
+
+		case ssd1306_transform_mirror_h:
+			for( unsigned x = 0; x < width; x++ ) {
+				line[x] = fetch_column(view, w - 1 - (u0 + x), v0);
+			}
+		break;
+
+		case ssd1306_transform_mirror_v:
+			for( unsigned x = 0; x < width; x++ ) {
+				line[x] = ssd1306_reverse_bits[fetch_column(view, u0 + x, h - 8 - v0)];
+			}
+		break;
+
+		case ssd1306_transform_rotate_180:
+			for( unsigned x = 0; x < width; x++ ) {
+				line[x] = ssd1306_reverse_bits[fetch_column(view, w - 1 - (u0 + x), h - 8 - v0)];
+			}
+		break;
+
+		case ssd1306_transform_rotate_90:
+		case ssd1306_transform_rotate_270:
+			for( unsigned x = 0; x < width; x += 8 ) {
+				const int16_t u = u0 + x;
+				uint8_t block[8];
+				uint8_t tile[8];
+
+				// rotate_90:  (u, v) <- (v, h - 1 - u)
+				// rotate_270: (u, v) <- (w - 1 - v, u)
+				for( unsigned j = 0; j < 8; j++ ) {
+					block[j] = transform == ssd1306_transform_rotate_90
+						? fetch_column(view, v0 + j, h - 8 - u)
+						: fetch_column(view, w - 1 - v0 - j, u);
+				}
+
+				ssd1306_transpose8(block, 1, tile, 1);
+
+				for( unsigned k = 0; k < 8 && x + k < width; k++ ) {
+					line[x + k] = tile[transform == ssd1306_transform_rotate_90 ? 7 - k : k];
+				}
+			}
+		break;
+
+		default:
+			ABORT_IF(true, "invalid transform %d", transform);
+	}
+}
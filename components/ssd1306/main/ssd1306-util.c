@@ -9,7 +9,7 @@ uint8_t* ssd1306_raster(ssd1306_t device, uint8_t page)
 
 	ssd1306_int_t const dev = (ssd1306_int_t)device;
 
-	return dev->buff + page * device->w;
+	return dev->raster + page * device->w;
 }
 
 bool ssd1306_trim(ssd1306_t device, ssd1306_bounds_t* bounds, const ssd1306_size_t* size)
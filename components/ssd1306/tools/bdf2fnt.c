@@ -34,6 +34,8 @@ static bool ends_with(const char *str, char *end)
 	return true;
 }
 
+#define MAX_CODE 0x10ffff
+
 static struct {
 	const char* program;
 
@@ -42,6 +44,9 @@ static struct {
 	unsigned to;
 	int verbosity;
 
+	uint32_t codes[MAX_CODE / 32 + 1]; // selected with -c, -k or -s, one bit each
+	bool subset; // otherwise everything from -f to -t
+
 	const char* input;
 } options = {
 	.from = 0,
@@ -51,18 +56,21 @@ static struct {
 static int get_next_option(int argc, char* const argv[])
 {
 	static struct option long_options[] = {
+		{ "codes", required_argument, 0, 0 },
 		{ "from", required_argument, 0, 0 },
 		{ "help", no_argument, 0, 0 },
+		{ "keep", required_argument, 0, 0 },
 		{ "output", required_argument, 0, 0 },
+		{ "scan", required_argument, 0, 0 },
 		{ "to", required_argument, 0, 0 },
 		{ "verbose", no_argument, 0, 0 },
 	};
-	static int short_options[] = { 'f', 'h', 'o', 't', 'v', };
+	static int short_options[] = { 'c', 'f', 'h', 'k', 'o', 's', 't', 'v', };
 
 	assert(_countof(long_options) == _countof(short_options));
 
 	int pos;
-	int opt = getopt_long(argc, argv, "f:h?o:t:v", long_options, &pos);
+	int opt = getopt_long(argc, argv, "c:f:h?k:o:s:t:v", long_options, &pos);
 
 	if( opt < 0 ) {
 		return -1;
@@ -78,9 +86,9 @@ static int get_next_option(int argc, char* const argv[])
 
 static int parse_int_value(const char* value, char** endp, int min, int max, const char* format, ... ) {
 	char* next;
-	long result = strtol(value, &next, 10);
+	long result = strtol(value, &next, 0);
 
-	if( next[0] && !isspace(next[0])) {
+	if( next == value || (next[0] && !isspace(next[0]) && next[0] != ',' && next[0] != '-') ) {
 		va_list args;
 
 		va_start(args, format);
@@ -114,6 +122,14 @@ static int parse_int_value(const char* value, char** endp, int min, int max, con
 static void usage(int code)
 {
 	fprintf(stderr, "Usage: %s [OPTIONS] <BDFFILE>\n", options.program);
+	fprintf(stderr, "  -c, --codes LIST    characters to convert, as in 32-126,0xb0,0x2500-0x257f\n");
+	fprintf(stderr, "  -f, --from CODE     first character to convert, defaults to 0\n");
+	fprintf(stderr, "  -t, --to CODE       last character to convert, defaults to 255\n");
+	fprintf(stderr, "  -k, --keep TEXT     characters of the UTF-8 text to convert\n");
+	fprintf(stderr, "  -s, --scan FILE     characters of the literals of a C source to convert, can be repeated\n");
+	fprintf(stderr, "                      -c, -k and -s add up, -f and -t apply when none is given\n");
+	fprintf(stderr, "  -o, --output FILE   generated font, defaults to the input with a .fnt extension\n");
+	fprintf(stderr, "  -v, --verbose       more output, can be repeated\n");
 	exit(code);
 }
 
@@ -137,6 +153,237 @@ static bool is_missing_or_is_file(const char* file)
 	return S_ISREG(st.st_mode);
 }
 
+static void select_code(unsigned code)
+{
+	options.codes[code / 32] |= 1u << (code % 32);
+	options.subset = true;
+}
+
+static bool is_selected(unsigned code)
+{
+	if( !options.subset ) {
+		return code >= options.from && code <= options.to;
+	}
+
+	return options.codes[code / 32] & (1u << (code % 32));
+}
+
+static void parse_codes(char* list)
+{
+	while( *list ) {
+		unsigned from = parse_int_value(list, &list, 0, MAX_CODE, "option -c/--codes");
+		unsigned to = from;
+
+		if( *list == '-' ) {
+			to = parse_int_value(list + 1, &list, from, MAX_CODE, "option -c/--codes");
+		}
+		if( *list == ',' ) {
+			list++;
+		}
+
+		for( unsigned code = from; code <= to; code++ ) {
+			select_code(code);
+		}
+	}
+}
+
+/*
+	Decodes the next character as the component does: bytes which can't
+	start a sequence stand for themselves, a truncated sequence is skipped
+	and the byte cutting it short starts the next character.
+*/
+static unsigned next_utf8(const uint8_t** text)
+{
+	const uint8_t* p = *text;
+	const unsigned lead = *p++;
+
+	if( lead < 0xc2 || lead > 0xf4 ) {
+		*text = p;
+
+		return lead;
+	}
+
+	const unsigned length = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : 1;
+	unsigned code = lead & (0x3f >> length);
+
+	for( unsigned k = 0; k < length; k++, p++ ) {
+		if( (*p & 0xc0) != 0x80 ) {
+			*text = p;
+
+			return MAX_CODE + 1; // dropped
+		}
+
+		code = (code << 6) | (*p & 0x3f);
+	}
+
+	*text = p;
+
+	return code;
+}
+
+// the control characters of a text, as the one switching colors, are never drawn
+static void keep_text(const uint8_t* text, const uint8_t* end)
+{
+	while( text < end ) {
+		const unsigned code = next_utf8(&text);
+
+		if( code >= 0x20 && code <= MAX_CODE ) {
+			select_code(code);
+		}
+	}
+}
+
+static void append_utf8(uint8_t* buff, unsigned* length, unsigned code)
+{
+	if( code < 0x80 ) {
+		buff[(*length)++] = code;
+	} else if( code < 0x800 ) {
+		buff[(*length)++] = 0xc0 | (code >> 6);
+		buff[(*length)++] = 0x80 | (code & 0x3f);
+	} else if( code < 0x10000 ) {
+		buff[(*length)++] = 0xe0 | (code >> 12);
+		buff[(*length)++] = 0x80 | ((code >> 6) & 0x3f);
+		buff[(*length)++] = 0x80 | (code & 0x3f);
+	} else {
+		buff[(*length)++] = 0xf0 | (code >> 18);
+		buff[(*length)++] = 0x80 | ((code >> 12) & 0x3f);
+		buff[(*length)++] = 0x80 | ((code >> 6) & 0x3f);
+		buff[(*length)++] = 0x80 | (code & 0x3f);
+	}
+}
+
+static unsigned read_digits(FILE* input, int base, unsigned max_digits, int* c)
+{
+	unsigned value = 0;
+
+	for( unsigned k = 0; k < max_digits && isxdigit(*c); k++ ) {
+		const unsigned digit = isdigit(*c) ? *c - '0' : tolower(*c) - 'a' + 10;
+
+		if( digit >= (unsigned)base ) {
+			break;
+		}
+
+		value = value * base + digit;
+		*c = fgetc(input);
+	}
+
+	return value;
+}
+
+/*
+	Keeps the characters of the string and character literals of a C or
+	C++ source, comments are skipped. Escapes are decoded first, then the
+	literal is decoded as UTF-8 as it would be on the device. Texts built
+	at run time from other characters, as numbers, need -c or -k.
+*/
+static void scan_source(const char* file)
+{
+	FILE* input = fopen(file, "r");
+
+	if( input == NULL ) {
+		fprintf(stderr, "%s: %s\n", file, strerror(errno));
+		exit(1);
+	}
+
+	uint8_t* literal = NULL;
+	unsigned capacity = 0;
+	int c = fgetc(input);
+
+	while( c != EOF ) {
+		if( c == '/' ) {
+			c = fgetc(input);
+
+			if( c == '/' ) {
+				while( c != EOF && c != '\n' ) {
+					c = fgetc(input);
+				}
+			} else if( c == '*' ) {
+				int previous = 0;
+
+				while( (c = fgetc(input)) != EOF && !(previous == '*' && c == '/') ) {
+					previous = c;
+				}
+
+				c = fgetc(input);
+			}
+
+			continue;
+		}
+
+		if( c != '"' && c != '\'' ) {
+			c = fgetc(input);
+
+			continue;
+		}
+
+		const int quote = c;
+		unsigned length = 0;
+
+		c = fgetc(input);
+
+		while( c != EOF && c != quote && c != '\n' ) {
+			if( length + 4 >= capacity ) {
+				capacity = capacity ? 2 * capacity : 256;
+				literal = realloc(literal, capacity);
+			}
+
+			if( c != '\\' ) {
+				literal[length++] = c;
+				c = fgetc(input);
+
+				continue;
+			}
+
+			c = fgetc(input);
+
+			switch( c ) {
+				case 'x':
+					c = fgetc(input);
+					literal[length++] = read_digits(input, 16, 8, &c);
+				break;
+
+				case 'u':
+				case 'U': {
+					const unsigned digits = c == 'u' ? 4 : 8;
+
+					c = fgetc(input);
+
+					const unsigned code = read_digits(input, 16, digits, &c);
+
+					append_utf8(literal, &length, code <= MAX_CODE ? code : '?');
+				}
+				break;
+
+				case '0': case '1': case '2': case '3':
+				case '4': case '5': case '6': case '7':
+					literal[length++] = read_digits(input, 8, 3, &c);
+				break;
+
+				case 'n': literal[length++] = '\n'; c = fgetc(input); break;
+				case 't': literal[length++] = '\t'; c = fgetc(input); break;
+				case 'r': literal[length++] = '\r'; c = fgetc(input); break;
+
+				case EOF:
+				break;
+
+				default:
+					literal[length++] = c;
+					c = fgetc(input);
+				break;
+			}
+		}
+
+		if( length ) {
+			keep_text(literal, literal + length);
+		}
+
+		c = c == quote ? fgetc(input) : c;
+	}
+
+	free(literal);
+	fclose(input);
+}
+
 static void parse_options(int argc, char* const argv[]) {
 	options.program = argv[0];
 
@@ -148,8 +395,20 @@ static void parse_options(int argc, char* const argv[]) {
 		}
 
 		switch (opt) {
+			case 'c':
+				parse_codes(optarg);
+			break;
+
+			case 'k':
+				keep_text((const uint8_t*)optarg, (const uint8_t*)optarg + strlen(optarg));
+			break;
+
+			case 's':
+				scan_source(optarg);
+			break;
+
 			case 'f':
-				options.from = parse_int_value(optarg, NULL, 0, 255, "option -f/--from");
+				options.from = parse_int_value(optarg, NULL, 0, MAX_CODE, "option -f/--from");
 			break;
 
 			case 'h':
@@ -162,7 +421,7 @@ static void parse_options(int argc, char* const argv[]) {
 			break;
 
 			case 't':
-				options.from = parse_int_value(optarg, NULL, 0, 255, "option -t/--to");
+				options.to = parse_int_value(optarg, NULL, 0, MAX_CODE, "option -t/--to");
 			break;
 
 			case 'v':
@@ -200,6 +459,9 @@ static void parse_options(int argc, char* const argv[]) {
 	}
 }
 
+#define MAX_WIDTH 32 // of a glyph bitmap, a row is read into 32 bits
+#define MAX_HEIGHT 32 // of the font, as supported by the component
+
 typedef enum {
 	state_idle,
 	state_glyph,
@@ -208,20 +470,19 @@ typedef enum {
 
 typedef struct {
 	char name[16];
-	unsigned width;
-	union {
-		unsigned index;
-		unsigned height;
-	};
+	unsigned width; // the advance
+	unsigned height;
 	int bbx[4];
 	unsigned encoding;
-	uint16_t image[0];
+	int top; // row of the cell the first bitmap row goes to
+	unsigned rows; // bitmap rows read so far
+	uint32_t image[MAX_HEIGHT]; // cell rows, pixel x at bit 31 - x
 } bdf_glyph_t;
 
 typedef struct {
 	uint8_t width;
 	uint8_t height;
-	uint8_t image[0];
+	uint8_t image[0]; // page-major
 } bdf_bitmap_t;
 
 typedef struct {
@@ -367,10 +628,12 @@ static bdf_glyph_t* parse_bdf_glyph(bdf_info_t* info)
 		switch( info->state ) {
 			case state_idle:
 				if( is_token(&line, "STARTCHAR") ) {
-					glyph = calloc(1, sizeof(bdf_glyph_t) + (info->height) * sizeof(glyph->image[0]));
+					glyph = calloc(1, sizeof(bdf_glyph_t));
 
 					strncpy(glyph->name, line, 15);
 
+					glyph->height = info->height;
+
 					info->state = state_glyph;
 
 					continue;
@@ -390,10 +653,10 @@ static bdf_glyph_t* parse_bdf_glyph(bdf_info_t* info)
 					continue;
 				}
 				if( is_token(&line, "BBX") ) {
-					glyph->bbx[0] = strtoul(line, &line, 10);
-					glyph->bbx[1] = strtoul(line, &line, 10);
-					glyph->bbx[2] = strtoul(line, &line, 10);
-					glyph->bbx[3] = strtoul(line, &line, 10);
+					glyph->bbx[0] = strtol(line, &line, 10);
+					glyph->bbx[1] = strtol(line, &line, 10);
+					glyph->bbx[2] = strtol(line, &line, 10);
+					glyph->bbx[3] = strtol(line, &line, 10);
 
 					if( options.verbosity > 2 ) {
 						printf("BBX = %d, %d, %d, %d\n",
@@ -405,10 +668,11 @@ static bdf_glyph_t* parse_bdf_glyph(bdf_info_t* info)
 				if( is_token(&line, "BITMAP") ) {
 					info->state = state_bitmap;
 
-					glyph->index = info->height - (glyph->bbx[1] + (info->descent + glyph->bbx[3]));
+					// the bounding box sits bbx[3] rows above the baseline
+					glyph->top = (int)info->ascent - (glyph->bbx[1] + glyph->bbx[3]);
 
 					if( options.verbosity > 2 ) {
-						printf("BITMAP %s starts at index = %d\n", glyph->name, glyph->index);
+						printf("BITMAP %s starts at row %d\n", glyph->name, glyph->top);
 					}
 
 					continue;
@@ -419,17 +683,34 @@ static bdf_glyph_t* parse_bdf_glyph(bdf_info_t* info)
 				if( is_token(&line, "ENDCHAR") ) {
 					info->state = state_idle;
 
-					glyph->height = info->height;
-
 					return glyph;
 				}
 
-				if( glyph->index < info->height ) {
-					glyph->image[glyph->index++] = strtoul(line, &line, 16) >> glyph->bbx[2];
-				} else {
-					fail(info, "glyph has too many bytes, index = %u, height = %u", glyph->index, info->height);
+				if( glyph->rows >= (unsigned)glyph->bbx[1] ) {
+					fail(info, "glyph has too many rows, height = %d", glyph->bbx[1]);
+				}
+
+				const size_t digits = strlen(line);
+
+				if( digits == 0 || digits > MAX_WIDTH / 4 ) {
+					fail(info, "invalid bitmap row, at most %u pixels are supported", MAX_WIDTH);
 				}
 
+				// left aligned, then moved to the horizontal offset of the bounding box
+				const uint32_t bits = (uint32_t)(strtoul(line, NULL, 16) << (32 - 4 * digits));
+				const int x = glyph->bbx[2];
+				const int y = glyph->top + (int)glyph->rows++;
+
+				if( y < 0 || y >= (int)glyph->height ) {
+					if( options.verbosity > 0 ) {
+						printf("glyph %s: row %d outside of the font, dropped\n", glyph->name, y);
+					}
+
+					continue;
+				}
+
+				glyph->image[y] = x >= MAX_WIDTH || x <= -MAX_WIDTH ? 0 : x >= 0 ? bits >> x : bits << -x;
+
 			continue;
 		}
 
@@ -441,17 +722,9 @@ static bdf_glyph_t* parse_bdf_glyph(bdf_info_t* info)
 
 void write_bitmap(bdf_info_t* info, const bdf_bitmap_t* bitmap)
 {
-	assert(sizeof(bitmap->width) == 1);
-	assert(sizeof(bitmap->height) == 1);
-
-	fwrite(&bitmap->width, 1, 1, info->output);
-	fwrite(&bitmap->height, 1, 1, info->output);
+	unsigned pages = (unsigned)bitmap->height / 8 + (unsigned)((bitmap->height % 8) ? 1 : 0);
 
-	unsigned rows = (unsigned)bitmap->height / 8 + (unsigned)((bitmap->height % 8) ? 1 : 0);
-
-	for( unsigned row = 0; row < rows; row++ ) {
-		fwrite(bitmap->image + row * bitmap->width, bitmap->width, 1, info->output);
-	}
+	fwrite(bitmap->image, bitmap->width, pages, info->output);
 }
 
 bool get_glyph_pixel(const bdf_glyph_t* glyph, unsigned x, unsigned y)
@@ -459,10 +732,7 @@ bool get_glyph_pixel(const bdf_glyph_t* glyph, unsigned x, unsigned y)
 	assert(x < glyph->width);
 	assert(y < glyph->height);
 
-	unsigned position = (x / 8) * glyph->height + y;
-	unsigned s_mask = 0x80 >> (x % 8);
-
-	return glyph->image[position] & s_mask;
+	return x < MAX_WIDTH && (glyph->image[y] & (0x80000000u >> x));
 }
 
 void set_bitmap_pixel(bdf_bitmap_t* bitmap, unsigned x, unsigned y, bool value)
@@ -483,7 +753,7 @@ void set_bitmap_pixel(bdf_bitmap_t* bitmap, unsigned x, unsigned y, bool value)
 
 bdf_bitmap_t* rotate_glyph(const bdf_glyph_t* glyph)
 {
-	unsigned pages = glyph->height / 8 + glyph->height % 8 ? 1 : 0;
+	unsigned pages = glyph->height / 8 + (glyph->height % 8 ? 1 : 0);
 
 	bdf_bitmap_t* bitmap = calloc(1, sizeof(bdf_bitmap_t) + pages * glyph->width);
 
@@ -499,6 +769,132 @@ bdf_bitmap_t* rotate_glyph(const bdf_glyph_t* glyph)
 	return bitmap;
 }
 
+typedef struct {
+	unsigned code;
+	bdf_bitmap_t* bitmap;
+} font_glyph_t;
+
+typedef struct {
+	unsigned first;
+	unsigned count;
+	unsigned glyph;
+} font_range_t;
+
+#define MAX_GAP 2 // missing codes filled with empty glyphs rather than starting a range
+
+static int compare_glyphs(const void* a, const void* b)
+{
+	const font_glyph_t* ga = a;
+	const font_glyph_t* gb = b;
+
+	return ga->code < gb->code ? -1 : ga->code > gb->code ? 1 : 0;
+}
+
+static void write_le(FILE* output, unsigned value, unsigned bytes)
+{
+	for( unsigned k = 0; k < bytes; k++ ) {
+		fputc((value >> (8 * k)) & 0xff, output);
+	}
+}
+
+/*
+	The layout of ssd1306_font_t: height, baseline and the number of
+	ranges and glyphs, then the ranges of consecutive code points, the
+	glyph table of widths and 16-bit offsets from the end of the table,
+	and last the page-major images. Everything is little endian.
+*/
+unsigned write_font(bdf_info_t* info, font_glyph_t* glyphs, unsigned glyphs_z)
+{
+	const unsigned pages = info->height / 8 + (info->height % 8 ? 1 : 0);
+
+	qsort(glyphs, glyphs_z, sizeof(font_glyph_t), compare_glyphs);
+
+	// a code encoded twice keeps one of its glyphs
+	unsigned unique = 0;
+
+	for( unsigned k = 0; k < glyphs_z; k++ ) {
+		if( unique && glyphs[unique - 1].code == glyphs[k].code ) {
+			free(glyphs[k].bitmap);
+		} else {
+			glyphs[unique++] = glyphs[k];
+		}
+	}
+
+	glyphs_z = unique;
+
+	font_range_t* ranges = calloc(glyphs_z, sizeof(font_range_t));
+	unsigned ranges_z = 0;
+	unsigned entries = 0;
+
+	for( unsigned k = 0; k < glyphs_z; k++ ) {
+		font_range_t* range = ranges_z ? ranges + ranges_z - 1 : NULL;
+
+		if( range && glyphs[k].code < range->first + range->count + MAX_GAP + 1
+			&& glyphs[k].code - range->first < 0xffff ) {
+			entries += glyphs[k].code - (range->first + range->count) + 1;
+			range->count = glyphs[k].code - range->first + 1;
+		} else {
+			range = ranges + ranges_z++;
+
+			range->first = glyphs[k].code;
+			range->count = 1;
+			range->glyph = entries++;
+		}
+	}
+
+	if( ranges_z > 0xffff || entries > 0xffff ) {
+		fail(info, "font too large, %u ranges of %u glyphs", ranges_z, entries);
+	}
+
+	write_le(info->output, info->height, 1);
+	write_le(info->output, info->ascent, 1);
+	write_le(info->output, ranges_z, 2);
+	write_le(info->output, entries, 2);
+
+	for( unsigned k = 0; k < ranges_z; k++ ) {
+		write_le(info->output, ranges[k].first, 4);
+		write_le(info->output, ranges[k].count, 2);
+		write_le(info->output, ranges[k].glyph, 2);
+	}
+
+	unsigned offset = 0;
+	unsigned next = 0;
+
+	for( unsigned k = 0; k < ranges_z; k++ ) {
+		for( unsigned code = ranges[k].first; code < ranges[k].first + ranges[k].count; code++ ) {
+			const bool present = glyphs[next].code == code;
+			const unsigned width = present ? glyphs[next++].bitmap->width : 0;
+
+			if( offset > 0xffff ) {
+				fail(info, "font too large, glyph offsets exceed 16 bits");
+			}
+
+			write_le(info->output, width, 1);
+			write_le(info->output, offset, 2);
+
+			offset += width * pages;
+		}
+	}
+
+	for( unsigned k = 0; k < glyphs_z; k++ ) {
+		write_bitmap(info, glyphs[k].bitmap);
+	}
+
+	if( options.verbosity > 0 ) {
+		const unsigned dense = 3 * (glyphs[glyphs_z - 1].code - glyphs[0].code + 1);
+
+		printf("font %s, %u rows, %u glyphs in %u ranges from %u to %u\n", info->name, info->height,
+			glyphs_z, ranges_z, glyphs[0].code, glyphs[glyphs_z - 1].code);
+		printf("%u bytes, of which %u of images, a dense table would take %u more\n",
+			6 + 8 * ranges_z + 3 * entries + offset, offset,
+			dense > 8 * ranges_z + 3 * entries ? dense - 8 * ranges_z - 3 * entries : 0);
+	}
+
+	free(ranges);
+
+	return glyphs_z;
+}
+
 int main(int argc, char* const argv[])
 {
 	parse_options(argc, argv);
@@ -510,6 +906,13 @@ int main(int argc, char* const argv[])
 
 	bdf_info_t* info = parse_bdf_info();
 
+	if( info->height == 0 || info->height > MAX_HEIGHT ) {
+		fail(info, "unsupported font height %u, at most %u", info->height, MAX_HEIGHT);
+	}
+
+	font_glyph_t* glyphs = NULL;
+	unsigned glyphs_z = 0;
+
 	bdf_glyph_t* glyph;
 
 	while( (glyph = parse_bdf_glyph(info)) ) {
@@ -523,35 +926,45 @@ int main(int argc, char* const argv[])
 		if( options.verbosity > 1 ) {
 			printf("\tbitmap ");
 
-			for( int b = 0; b < glyph->height; b++ ) {
-				printf("%0*x ", glyph->width/4, glyph->image[b]);
+			for( unsigned b = 0; b < glyph->height; b++ ) {
+				printf("%08x ", glyph->image[b]);
 			}
 
 			printf("\n");
 		}
 
-		if( info->width && glyph->width > info->width ) {
-			fail(info, "invalid glyph size %dx%d exceeding %dx%d",
-				 glyph->width, glyph->height, info->width, info->height);
-		}
-		if( info->height && glyph->height > info->height ) {
-			fail(info, "invalid glyph size %dx%d exceeding %dx%d",
-				 glyph->width, glyph->height, info->width, info->height);
+		if( glyph->width > 255 ) {
+			fail(info, "invalid glyph width %u", glyph->width);
 		}
 
-		if( glyph->encoding >= options.from && glyph->encoding <= options.to ) {
-			bdf_bitmap_t* bitmap = rotate_glyph(glyph);
+		if( glyph->encoding <= MAX_CODE && is_selected(glyph->encoding) ) {
+			glyphs = realloc(glyphs, (glyphs_z + 1) * sizeof(font_glyph_t));
 
-			write_bitmap(info, bitmap);
+			glyphs[glyphs_z].code = glyph->encoding;
+			glyphs[glyphs_z].bitmap = rotate_glyph(glyph);
 
-			free(bitmap);
+			glyphs_z++;
 		}
 
 		free(glyph);
 	}
 
+	if( glyphs_z == 0 ) {
+		fail(info, "no glyphs selected");
+	}
+
+	glyphs_z = write_font(info, glyphs, glyphs_z);
+
+	for( unsigned k = 0; k < glyphs_z; k++ ) {
+		free(glyphs[k].bitmap);
+	}
+
+	free(glyphs);
+
 	fclose(info->input);
 	fclose(info->output);
 
+	free(info);
+
 	return 0;
 }
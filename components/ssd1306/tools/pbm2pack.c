@@ -0,0 +1,392 @@
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define _countof(x) (sizeof(x)/sizeof(x[0]))
+
+static bool ends_with(const char *str, char *end)
+{
+	int str_len = strlen(str);
+	int end_len = strlen(end);
+
+	if( end_len > str_len ) {
+		return false;
+	}
+
+	while( end_len > 0 ) {
+		if( str[--str_len] != end[--end_len] ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static struct {
+	const char* program;
+
+	char* name;
+	char* output;
+	int verbosity;
+
+	const char* input;
+} options;
+
+static int get_next_option(int argc, char* const argv[])
+{
+	static struct option long_options[] = {
+		{ "help", no_argument, 0, 0 },
+		{ "name", required_argument, 0, 0 },
+		{ "output", required_argument, 0, 0 },
+		{ "verbose", no_argument, 0, 0 },
+	};
+	static int short_options[] = { 'h', 'n', 'o', 'v', };
+
+	assert(_countof(long_options) == _countof(short_options));
+
+	int pos;
+	int opt = getopt_long(argc, argv, "h?n:o:v", long_options, &pos);
+
+	if( opt < 0 ) {
+		return -1;
+	}
+	if( opt == 0 ) {
+		assert(pos < _countof(short_options));
+
+		opt = short_options[pos];
+	}
+
+	return opt;
+}
+
+static void usage(int code)
+{
+	fprintf(stderr, "Usage: %s [OPTIONS] <PBMFILE>\n", options.program);
+	fprintf(stderr, "  -n, --name NAME     name of the generated variable, defaults to the file name\n");
+	fprintf(stderr, "  -o, --output FILE   generated C source, defaults to the input with a .c extension\n");
+	fprintf(stderr, "  -v, --verbose       print the compression ratio\n");
+	exit(code);
+}
+
+static void parse_options(int argc, char* const argv[]) {
+	options.program = argv[0];
+
+	while( true ) {
+		int opt = get_next_option(argc, argv);
+
+		if( opt < 0 ) {
+			break;
+		}
+
+		switch (opt) {
+			case 'h':
+			case '?':
+				usage(0);
+			break;
+
+			case 'n':
+				options.name = strdup(optarg);
+			break;
+
+			case 'o':
+				options.output = strdup(optarg);
+			break;
+
+			case 'v':
+				options.verbosity++;
+			break;
+
+			default:
+				usage(1);
+			break;
+		}
+	}
+
+	if( optind == argc ) {
+		usage(1);
+	}
+
+	options.input = argv[optind];
+
+	if( !ends_with(options.input, ".pbm") ) {
+		fprintf(stderr, "invalid extension of input file, should end with \".pbm\"\n");
+		exit(1);
+	}
+
+	if( !options.output ) {
+		options.output = strdup(options.input);
+
+		int len = strlen(options.output);
+
+		strcpy(options.output + len - 3, "c");
+	}
+
+	if( !options.name ) {
+		const char* base = strrchr(options.input, '/');
+
+		options.name = strdup(base ? base + 1 : options.input);
+		options.name[strlen(options.name) - 4] = 0;
+
+		for( char* p = options.name; *p; p++ ) {
+			if( !isalnum(*p) ) {
+				*p = '_';
+			}
+		}
+
+		// an identifier can't start with a digit
+		if( isdigit(options.name[0]) ) {
+			char* name = malloc(strlen(options.name) + 2);
+
+			name[0] = '_';
+			strcpy(name + 1, options.name);
+
+			free(options.name);
+			options.name = name;
+		}
+	}
+}
+
+typedef struct {
+	unsigned width;
+	unsigned height;
+	uint8_t image[]; // page-major, as ssd1306_bitmap_t
+} pbm_image_t;
+
+static void fail(const char* format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+
+	fputs("\n", stderr);
+
+	exit(1);
+}
+
+static unsigned read_header_value(FILE* input)
+{
+	int c;
+
+	while( (c = fgetc(input)) != EOF ) {
+		if( c == '#' ) {
+			while( (c = fgetc(input)) != EOF && c != '\n' ) {
+			}
+		} else if( !isspace(c) ) {
+			break;
+		}
+	}
+
+	if( !isdigit(c) ) {
+		fail("%s: invalid header", options.input);
+	}
+
+	unsigned value = 0;
+
+	while( isdigit(c) ) {
+		value = value * 10 + (c - '0');
+		c = fgetc(input);
+	}
+
+	return value;
+}
+
+static bool read_plain_pixel(FILE* input)
+{
+	int c;
+
+	while( (c = fgetc(input)) != EOF && isspace(c) ) {
+	}
+
+	if( c != '0' && c != '1' ) {
+		fail("%s: invalid pixel", options.input);
+	}
+
+	return c == '1';
+}
+
+static pbm_image_t* read_pbm()
+{
+	FILE* input = fopen(options.input, "rb");
+
+	if( input == NULL ) {
+		fail("%s: %s", options.input, strerror(errno));
+	}
+
+	char magic[2];
+
+	if( fread(magic, 1, 2, input) != 2 || magic[0] != 'P' || (magic[1] != '1' && magic[1] != '4') ) {
+		fail("%s: not a PBM file", options.input);
+	}
+
+	const unsigned width = read_header_value(input);
+	const unsigned height = read_header_value(input);
+
+	if( width == 0 || height == 0 || width > 0xffff || height > 0xffff ) {
+		fail("%s: invalid size %ux%u", options.input, width, height);
+	}
+
+	const unsigned pages = (height + 7) / 8;
+
+	pbm_image_t* image = calloc(1, sizeof(pbm_image_t) + pages * width);
+
+	image->width = width;
+	image->height = height;
+
+	const unsigned stride = (width + 7) / 8;
+	uint8_t* row = malloc(stride);
+
+	for( unsigned y = 0; y < height; y++ ) {
+		if( magic[1] == '4' ) {
+			if( fread(row, 1, stride, input) != stride ) {
+				fail("%s: unexpected EOF", options.input);
+			}
+		} else {
+			memset(row, 0, stride);
+
+			for( unsigned x = 0; x < width; x++ ) {
+				row[x / 8] |= read_plain_pixel(input) ? 0x80 >> (x % 8) : 0;
+			}
+		}
+
+		for( unsigned x = 0; x < width; x++ ) {
+			if( row[x / 8] & (0x80 >> (x % 8)) ) {
+				image->image[(y / 8) * width + x] |= 1 << (y % 8);
+			}
+		}
+	}
+
+	free(row);
+	fclose(input);
+
+	return image;
+}
+
+/*
+	Run-length encoding of our own, PackBits-like but not compatible with
+	it (PackBits repeats 257 - c times): runs of 2 or more equal bytes
+	become a control byte of count + 126 followed by the byte, anything
+	else goes into literals of up to 128 bytes, introduced by a control
+	byte of length - 1.
+*/
+static unsigned pack_page(const uint8_t* page, unsigned width, uint8_t* output)
+{
+	unsigned size = 0;
+	unsigned x = 0;
+
+	while( x < width ) {
+		unsigned run = 1;
+
+		while( x + run < width && run < 129 && page[x + run] == page[x] ) {
+			run++;
+		}
+
+		if( run >= 2 ) {
+			output[size++] = run + 126;
+			output[size++] = page[x];
+
+			x += run;
+
+			continue;
+		}
+
+		// a literal ends before a run of 3, a run of 2 is cheaper kept inside
+		unsigned count = 1;
+
+		while( x + count < width && count < 128 ) {
+			if( x + count + 2 < width
+				&& page[x + count] == page[x + count + 1]
+				&& page[x + count] == page[x + count + 2] ) {
+				break;
+			}
+
+			count++;
+		}
+
+		output[size++] = count - 1;
+
+		memcpy(output + size, page + x, count);
+
+		size += count;
+		x += count;
+	}
+
+	return size;
+}
+
+static void write_packed(const pbm_image_t* image)
+{
+	const unsigned pages = (image->height + 7) / 8;
+
+	// the worst case adds one control byte every 128 literals
+	uint8_t* data = malloc(pages * (image->width + image->width / 128 + 1));
+	unsigned* offsets = calloc(pages + 1, sizeof(unsigned));
+
+	for( unsigned page = 0; page < pages; page++ ) {
+		offsets[page + 1] = offsets[page]
+			+ pack_page(image->image + page * image->width, image->width, data + offsets[page]);
+	}
+
+	if( offsets[pages - 1] > 0xffff ) {
+		fail("%s: image too large, page offsets exceed 16 bits", options.input);
+	}
+
+	FILE* output = fopen(options.output, "w");
+
+	if( output == NULL ) {
+		fail("%s: %s", options.output, strerror(errno));
+	}
+
+	fprintf(output, "#include <ssd1306.h>\n\n");
+	fprintf(output, "// %ux%u, %u bytes packed, %u raw\n", image->width, image->height,
+		2 * pages + offsets[pages], pages * image->width);
+	fprintf(output, "const ssd1306_packed_t %s = {\n", options.name);
+	fprintf(output, "\tw: %u, h: %u,\n\n", image->width, image->height);
+	fprintf(output, "\tdata: {\n\t\t");
+
+	for( unsigned page = 0; page < pages; page++ ) {
+		fprintf(output, "0x%02x, 0x%02x, ", offsets[page] & 0xff, offsets[page] >> 8);
+	}
+
+	for( unsigned page = 0; page < pages; page++ ) {
+		for( unsigned k = offsets[page]; k < offsets[page + 1]; k++ ) {
+			fprintf(output, "%s0x%02x,", (k - offsets[page]) % 16 ? " " : "\n\t\t", data[k]);
+		}
+
+		fprintf(output, "\n");
+	}
+
+	fprintf(output, "\t}\n};\n");
+	fclose(output);
+
+	if( options.verbosity > 0 ) {
+		printf("%s: %ux%u, %u bytes packed, %u raw\n", options.output, image->width, image->height,
+			2 * pages + offsets[pages], pages * image->width);
+	}
+
+	free(offsets);
+	free(data);
+}
+
+int main(int argc, char* const argv[])
+{
+	parse_options(argc, argv);
+
+	pbm_image_t* image = read_pbm();
+
+	write_packed(image);
+
+	free(image);
+
+	return 0;
+}
@@ -30,8 +30,8 @@ void scroll_bitmap(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
 {
 	TickType_t ticks = xTaskGetTickCount();
 
-	ssd1306_bitmap_t* moving = ssd1306_create_bitmap((ssd1306_size_t){w: bitmap->w, h: bitmap->h});
 	ssd1306_bounds_t bounds;
+	ssd1306_bounds_t band;
 
 	ssd1306_center_bounds(device, &bounds, bitmap);
 
@@ -43,14 +43,13 @@ void scroll_bitmap(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
 	ssd1306_draw(device, &bounds, bitmap);
 	vTaskDelayUntil(&ticks, pdMS_TO_TICKS(2500));
 
+	band = (ssd1306_bounds_t){ x0: 0, y0: bounds.y0, x1: device->w, y1: bounds.y1 };
+
 	ssd1306_auto_update(device, false);
 	while( bounds.x0 <  (int)device->w ) {
-		ssd1306_grab(device, &bounds, moving);
-		ssd1306_clear(device, &bounds);
-
+		ssd1306_scroll(device, &band, 1, 0, false);
 		ssd1306_bounds_move_by(&bounds, (ssd1306_point_t){ 1, 0 });
 
-		ssd1306_draw(device, &bounds, moving);
 		ssd1306_status(device, ssd1306_status_ext, "x: %+4d, y: %+3d", bounds.x0, bounds.y0);
 
 		ssd1306_update(device);
@@ -63,14 +62,13 @@ void scroll_bitmap(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
 	ssd1306_draw(device, &bounds, bitmap);
 	vTaskDelayUntil(&ticks, pdMS_TO_TICKS(2500));
 
+	band = (ssd1306_bounds_t){ x0: bounds.x0, y0: 0, x1: bounds.x1, y1: device->h };
+
 	ssd1306_auto_update(device, false);
 	while( bounds.y0 < (int)device->h ) {
-		ssd1306_grab(device, &bounds, moving);
-		ssd1306_clear(device, &bounds);
-
+		ssd1306_scroll(device, &band, 0, 1, false);
 		ssd1306_bounds_move_by(&bounds, (ssd1306_point_t){ 0, 1 });
 
-		ssd1306_draw(device, &bounds, moving);
 		ssd1306_status(device, ssd1306_status_ext, "x: %+4d, y: %+3d", bounds.x0, bounds.y0);
 
 		ssd1306_update(device);
@@ -79,8 +77,6 @@ void scroll_bitmap(ssd1306_t device, const ssd1306_bitmap_t* bitmap)
 	ssd1306_auto_update(device, true);
 
 	vTaskDelayUntil(&ticks, pdMS_TO_TICKS(2500));
-
-	free(moving);
 }
 
 void app_main(void)
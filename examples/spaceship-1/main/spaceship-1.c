@@ -95,6 +95,9 @@ void app_main(void)
 {
 	ssd1306_t device = ssd1306_init(NULL);
 
+	// reuses the shifted images when the shift cache is enabled
+	ssd1306_register_sprite(device, &spaceship_bmp);
+
 	ssd1306_clear(device, &device->bounds);
 	bouncing_bitmap(device, false);
 
@@ -83,6 +83,13 @@ void app_main(void)
 
 	uint16_t count = 0;
 
+	// only the digits which changed are redrawn and sent
+	ssd1306_field_t fields[3] = {
+		{ bounds: { x0: 0, y0: 0, x1: 128, y1: 8 } },
+		{ bounds: { x0: 0, y0: 8, x1: 128, y1: 16 } },
+		{ bounds: { x0: 0, y0: 16, x1: 128, y1: 24 } },
+	};
+
 	while( true ) {
 		ssd1306_bounds_t bounds = {
 			x0: 64, 
@@ -95,16 +102,15 @@ void app_main(void)
 
 		ssd1306_clear(device, &device->bounds);
 
+		for( uint8_t k = 0; k < 3; k++ ) {
+			fields[k].drawn = false;
+		}
+
 		while( bounds.y1 > bounds.y0 ) {
-			uint16_t pos = 0;
-			ssd1306_text(device, &(ssd1306_bounds_t){ x0: 0, y0: 8*pos, x1: 128, y1: 8*(pos+1) }, 
-					"P0: %+3d%+3d", bounds.x0, bounds.y0);
-			pos++;
-			ssd1306_text(device, &(ssd1306_bounds_t){ x0: 0, y0: 8*pos, x1: 128, y1: 8*(pos+1) },
-					"P1: %+3d%+3d", bounds.x1, bounds.y1);
-			pos++;
-			ssd1306_text(device, &(ssd1306_bounds_t){ x0: 0, y0: 8*pos, x1: 128, y1: 8*(pos+1) },
-					"SZ:  %2ux%2u",  ssd1306_bounds_width(&bounds), ssd1306_bounds_height(&bounds));
+			ssd1306_field(device, &fields[0], "P0: %+3d%+3d", bounds.x0, bounds.y0);
+			ssd1306_field(device, &fields[1], "P1: %+3d%+3d", bounds.x1, bounds.y1);
+			ssd1306_field(device, &fields[2], "SZ:  %2ux%2u",
+					ssd1306_bounds_width(&bounds), ssd1306_bounds_height(&bounds));
 
 			ssd1306_draw(device, &bounds, &ugly_bitmap);
 			ssd1306_auto_update(device, true);
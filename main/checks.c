@@ -1,8 +1,5 @@
 #include "checks.h"
 
-#define VERIFY_EQ(expected, actual) \
-	ABORT_IF((expected) != (actual), "expected %d, actual %d", (expected), (actual))
-
 void verify_bounds(const char* file, int line, int16_t x0, int16_t y0, int16_t x1, int16_t y1, const ssd1306_bounds_t* source)
 {
 	LOG_I("test from %s:%d", file, line);
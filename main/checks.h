@@ -13,4 +13,9 @@ extern void verify_bounds(const char* file, int line,
 #define VERIFY_NOT_NULL(source) \
 	ABORT_IF_NULL(source)
 
+#define VERIFY_EQ(expected, actual) \
+	ABORT_IF((expected) != (actual), "expected %d, actual %d", (expected), (actual))
+
 extern void test_geom();
+extern void test_bits();
+extern void test_draw(ssd1306_t device);
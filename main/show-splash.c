@@ -15,8 +15,12 @@ void app_main(void)
 #endif
 
 	test_geom();
+	test_bits();
 
 	ssd1306_t device = ssd1306_init(NULL);
+
+	test_draw(device);
+
 	TickType_t ticks = xTaskGetTickCount();
 
 	const char* text0 = "application has been initialised...";
@@ -31,9 +35,11 @@ void app_main(void)
 		0, (1-2*device->flip)*(device->h - ssd1306_bounds_height(&bounds)),
 	});
 
+	ssd1306_field_t field = { bounds: bounds };
+
 	for( int k = 60; k >= 0; k-- ) {
 		vTaskDelayUntil(&ticks, pdMS_TO_TICKS(1000));
-		ssd1306_text(device, &bounds, text1, k);
+		ssd1306_field(device, &field, text1, k);
 	}
 
 	ssd1306_clear(device, NULL);
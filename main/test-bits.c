@@ -0,0 +1,100 @@
+#include "checks.h"
+
+static void test_reverse()
+{
+	VERIFY_EQ(0x00, ssd1306_reverse_bits[0x00]);
+	VERIFY_EQ(0x80, ssd1306_reverse_bits[0x01]);
+	VERIFY_EQ(0x0f, ssd1306_reverse_bits[0xf0]);
+	VERIFY_EQ(0xa6, ssd1306_reverse_bits[0x65]);
+	VERIFY_EQ(0xff, ssd1306_reverse_bits[0xff]);
+}
+
+static void test_transpose()
+{
+	const uint8_t diagonal[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+	const uint8_t column[8] = { 0xff, 0, 0, 0, 0, 0, 0, 0 };
+	uint8_t target[16] = { };
+
+	ssd1306_transpose8(diagonal, 1, target, 1);
+
+	for( unsigned k = 0; k < 8; k++ ) {
+		VERIFY_EQ(diagonal[k], target[k]);
+	}
+
+	memset(target, 0, sizeof(target));
+	ssd1306_transpose8(column, 1, target, 2);
+
+	for( unsigned k = 0; k < 8; k++ ) {
+		VERIFY_EQ(0x01, target[2 * k]);
+		VERIFY_EQ(0x00, target[2 * k + 1]);
+	}
+}
+
+static void test_import()
+{
+	// 10x3 pixels, MSB first
+	const uint8_t rows[] = { 0x80, 0x00, 0xff, 0xc0, 0x00, 0x40 };
+
+	ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap_rows((ssd1306_size_t){ 10, 3 }, rows, 2, ssd1306_msb_first);
+
+	VERIFY_EQ(0x03, bitmap->image[0]);
+	VERIFY_EQ(0x02, bitmap->image[7]);
+	VERIFY_EQ(0x02, bitmap->image[8]);
+	VERIFY_EQ(0x06, bitmap->image[9]);
+
+	// the first row again, as the last one and LSB first
+	ssd1306_bitmap_import(bitmap, 2, 1, rows, 2, ssd1306_lsb_first);
+
+	VERIFY_EQ(0x03, bitmap->image[0]);
+	VERIFY_EQ(0x06, bitmap->image[7]);
+	VERIFY_EQ(0x02, bitmap->image[9]);
+
+	free(bitmap);
+}
+
+static void test_dither()
+{
+	// 24x8 pixels: black, mid gray and white squares
+	uint8_t rows[8][24];
+
+	for( unsigned y = 0; y < 8; y++ ) {
+		memset(rows[y], 0x00, 8);
+		memset(rows[y] + 8, 0x80, 8);
+		memset(rows[y] + 16, 0xff, 8);
+	}
+
+	for( ssd1306_dither_mode_t mode = ssd1306_dither_ordered; mode <= ssd1306_dither_diffusion; mode++ ) {
+		ssd1306_bitmap_t* bitmap = ssd1306_create_bitmap((ssd1306_size_t){ 24, 8 });
+		ssd1306_dither_t* dither = ssd1306_create_dither(24, mode);
+
+		// two bands, not aligned to the page
+		ssd1306_dither_bitmap(dither, bitmap, rows[0], 24, 3);
+		ssd1306_dither_bitmap(dither, bitmap, rows[3], 24, 5);
+
+		unsigned gray = 0;
+
+		for( unsigned x = 0; x < 8; x++ ) {
+			VERIFY_EQ(0x00, bitmap->image[x]);
+			VERIFY_EQ(0xff, bitmap->image[x + 16]);
+
+			gray += __builtin_popcount(bitmap->image[x + 8]);
+		}
+
+		if( mode == ssd1306_dither_ordered ) {
+			VERIFY_EQ(32, gray);
+		}
+
+		free(dither);
+		free(bitmap);
+	}
+}
+
+void test_bits()
+{
+	LOG_I("testing bits");
+
+	test_reverse();
+	test_transpose();
+	test_import();
+	test_dither();
+}
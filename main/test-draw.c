@@ -0,0 +1,793 @@
+#include "checks.h"
+
+static const ssd1306_bitmap_t cross_bmp = {
+	w: 5, h: 5,
+
+	image: { 0x04, 0x04, 0x1f, 0x04, 0x04 },
+};
+
+static const ssd1306_bitmap_t frame_bmp = {
+	w: 5, h: 5,
+
+	image: { 0x1f, 0x11, 0x11, 0x11, 0x1f },
+};
+
+// a column, a top row and a lone pixel at the bottom right, the same in no two transforms
+static const ssd1306_bitmap_t flag_bmp = {
+	w: 6, h: 3,
+
+	image: { 0x07, 0x01, 0x01, 0x00, 0x00, 0x04 },
+};
+
+static const ssd1306_packed_t frame_packed = {
+	w: 5, h: 5,
+
+	data: { 0x00, 0x00, 0x00, 0x1f, 0x81, 0x11, 0x00, 0x1f },
+};
+
+static const ssd1306_bitmap_t sheet_bmp = {
+	w: 10, h: 7,
+
+	image: { 0x10, 0x10, 0x7c, 0x10, 0x10, 0x7c, 0x44, 0x44, 0x44, 0x7c },
+};
+
+// 'A' and 'B' two pages high, laid out as bdf2fnt does
+static const uint8_t tall_fnt[] = {
+	16, 12, 1, 0, 2, 0,
+	'A', 0, 0, 0, 2, 0, 0, 0,
+	4, 0, 0,
+	3, 8, 0,
+	0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81,
+	0xff, 0x00, 0xaa, 0x55, 0x00, 0xff,
+};
+
+static const ssd1306_bitmap_t tall_bmp = {
+	w: 7, h: 16,
+
+	image: {
+		0x81, 0x42, 0x24, 0x18, 0xff, 0x00, 0xaa,
+		0x18, 0x24, 0x42, 0x81, 0x55, 0x00, 0xff,
+	},
+};
+
+static bool get_pixel(ssd1306_t device, int16_t x, int16_t y)
+{
+	return ssd1306_raster(device, y / 8)[x] & (1 << (y % 8));
+}
+
+static void verify_pixels(ssd1306_t device, int16_t x, int16_t y, const ssd1306_bitmap_t* bitmap)
+{
+	for( int16_t j = 0; j < bitmap->h; j++ ) {
+		for( int16_t i = 0; i < bitmap->w; i++ ) {
+			const bool expected = (bitmap->image[(j / 8) * bitmap->w + i] & (1 << (j % 8))) != 0;
+
+			VERIFY_EQ(expected, get_pixel(device, x + i, y + j));
+		}
+	}
+}
+
+static void test_rop(ssd1306_t device)
+{
+	ssd1306_bounds_t bounds = { x0: 3, y0: 6, x1: 8, y1: 11 };
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_draw_rop(device, &bounds, &frame_bmp, ssd1306_rop_or);
+	ssd1306_draw_rop(device, &bounds, &cross_bmp, ssd1306_rop_xor);
+	ssd1306_draw_rop(device, &bounds, &cross_bmp, ssd1306_rop_xor);
+	verify_pixels(device, 3, 6, &frame_bmp);
+
+	ssd1306_draw_rop(device, &bounds, &frame_bmp, ssd1306_rop_and_not);
+	VERIFY_EQ(false, get_pixel(device, 3, 6));
+	VERIFY_EQ(false, get_pixel(device, 7, 10));
+}
+
+static void test_masked(ssd1306_t device)
+{
+	ssd1306_bounds_t bounds = { x0: -1, y0: 13, x1: 4, y1: 18 };
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_draw_rop(device, &bounds, &frame_bmp, ssd1306_rop_copy);
+	ssd1306_draw_masked(device, &bounds, &cross_bmp, &cross_bmp, ssd1306_rop_copy);
+
+	VERIFY_EQ(true, get_pixel(device, 0, 13));
+	VERIFY_EQ(true, get_pixel(device, 1, 15));
+	VERIFY_EQ(false, get_pixel(device, 0, 14));
+	VERIFY_EQ(true, get_pixel(device, 3, 17));
+}
+
+static void test_sheet(ssd1306_t device)
+{
+	// within the top left 32x32 pixels, which every raster has
+	ssd1306_bounds_t bounds = { x0: 20, y0: 22, x1: 25, y1: 27 };
+	ssd1306_view_t view;
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_draw2(device, &sheet_bmp, &bounds, &(ssd1306_bounds_t){ x0: 5, y0: 2, x1: 10, y1: 7 });
+	verify_pixels(device, 20, 22, &frame_bmp);
+
+	VERIFY_NOT_NULL(ssd1306_view(&view, &sheet_bmp, &(ssd1306_bounds_t){ x0: 0, y0: 2, x1: 5, y1: 7 }));
+	VERIFY_EQ(2, view.shift);
+
+	ssd1306_draw_view(device, &bounds, &view, NULL, ssd1306_rop_xor);
+	VERIFY_EQ(false, get_pixel(device, 20, 24));
+	VERIFY_EQ(true, get_pixel(device, 22, 24));
+
+	ssd1306_draw_view(device, &bounds, &view, NULL, ssd1306_rop_xor);
+	verify_pixels(device, 20, 22, &frame_bmp);
+}
+
+static void test_transformed(ssd1306_t device)
+{
+	// where the lone pixel of the flag goes in each transform
+	const struct {
+		ssd1306_transform_t transform;
+		ssd1306_point_t lone;
+	} cases[] = {
+		{ ssd1306_transform_none, { x: 5, y: 2 } },
+		{ ssd1306_transform_mirror_h, { x: 0, y: 2 } },
+		{ ssd1306_transform_mirror_v, { x: 5, y: 0 } },
+		{ ssd1306_transform_rotate_90, { x: 0, y: 5 } },
+		{ ssd1306_transform_rotate_180, { x: 0, y: 0 } },
+		{ ssd1306_transform_rotate_270, { x: 2, y: 0 } },
+	};
+	const ssd1306_point_t origins[] = { { x: 3, y: 16 }, { x: 13, y: 21 } };
+	ssd1306_view_t view;
+
+	VERIFY_NOT_NULL(ssd1306_view(&view, &flag_bmp, NULL));
+
+	for( unsigned o = 0; o < _countof(origins); o++ ) {
+		for( unsigned c = 0; c < _countof(cases); c++ ) {
+			const ssd1306_transform_t transform = cases[c].transform;
+			const ssd1306_size_t size = ssd1306_transform_size(flag_bmp.size, transform);
+			const int16_t x = origins[o].x;
+			const int16_t y = origins[o].y;
+
+			ssd1306_clear(device, NULL);
+			ssd1306_draw_transformed(device,
+				&(ssd1306_bounds_t){ x0: x, y0: y, x1: x + size.w, y1: y + size.h },
+				&view, NULL, transform, ssd1306_rop_copy);
+
+			for( int16_t v = 0; v < size.h; v++ ) {
+				for( int16_t u = 0; u < size.w; u++ ) {
+					int16_t i = u, j = v;
+
+					switch( transform ) {
+						case ssd1306_transform_mirror_h: i = flag_bmp.w - 1 - u; break;
+						case ssd1306_transform_mirror_v: j = flag_bmp.h - 1 - v; break;
+						case ssd1306_transform_rotate_90: i = v; j = flag_bmp.h - 1 - u; break;
+						case ssd1306_transform_rotate_180: i = flag_bmp.w - 1 - u; j = flag_bmp.h - 1 - v; break;
+						case ssd1306_transform_rotate_270: i = flag_bmp.w - 1 - v; j = u; break;
+						default: break;
+					}
+
+					const bool expected = (flag_bmp.image[i] & (1 << j)) != 0;
+
+					VERIFY_EQ(expected, get_pixel(device, x + u, y + v));
+				}
+			}
+
+			VERIFY_EQ(true, get_pixel(device, x + cases[c].lone.x, y + cases[c].lone.y));
+			VERIFY_EQ(false, get_pixel(device, x + size.w, y));
+			VERIFY_EQ(false, get_pixel(device, x, y + size.h));
+		}
+	}
+}
+
+static void test_scroll(ssd1306_t device)
+{
+	// within the top left 32x32 pixels, which every raster has
+	ssd1306_bounds_t bounds = { x0: 4, y0: 12, x1: 28, y1: 28 };
+
+	ssd1306_clear(device, NULL);
+	ssd1306_draw(device, &(ssd1306_bounds_t){ x0: 8, y0: 14, x1: 13, y1: 19 }, &frame_bmp);
+
+	ssd1306_scroll(device, &bounds, 3, 5, false);
+	verify_pixels(device, 11, 19, &frame_bmp);
+	VERIFY_EQ(false, get_pixel(device, 8, 14));
+
+	ssd1306_scroll(device, &bounds, -3, -5, true);
+	verify_pixels(device, 8, 14, &frame_bmp);
+	VERIFY_EQ(true, get_pixel(device, 27, 27));
+	VERIFY_EQ(false, get_pixel(device, 28, 27));
+}
+
+static void test_fill(ssd1306_t device)
+{
+	// within the top left 32x32 pixels, which every raster has
+	ssd1306_bounds_t bounds = { x0: 3, y0: 5, x1: 29, y1: 30 };
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_fill(device, &bounds, true);
+	VERIFY_EQ(true, get_pixel(device, 3, 5));
+	VERIFY_EQ(true, get_pixel(device, 28, 29));
+	VERIFY_EQ(false, get_pixel(device, 2, 5));
+	VERIFY_EQ(false, get_pixel(device, 3, 4));
+	VERIFY_EQ(false, get_pixel(device, 29, 29));
+	VERIFY_EQ(false, get_pixel(device, 28, 30));
+
+	ssd1306_invert_region(device, &(ssd1306_bounds_t){ x0: 0, y0: 0, x1: 10, y1: 10 });
+	VERIFY_EQ(true, get_pixel(device, 0, 0));
+	VERIFY_EQ(false, get_pixel(device, 5, 7));
+	VERIFY_EQ(true, get_pixel(device, 10, 7));
+
+	ssd1306_fill_pattern(device, &bounds, &ssd1306_pattern_checker, ssd1306_rop_and);
+	VERIFY_EQ(true, get_pixel(device, 10, 10));
+	VERIFY_EQ(false, get_pixel(device, 10, 11));
+	VERIFY_EQ(false, get_pixel(device, 11, 10));
+	VERIFY_EQ(true, get_pixel(device, 11, 11));
+}
+
+static void test_shapes(ssd1306_t device)
+{
+	ssd1306_bounds_t bounds = { x0: 10, y0: 6, x1: 30, y1: 20 };
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_rect(device, &bounds, false, ssd1306_color_invert);
+	VERIFY_EQ(true, get_pixel(device, 10, 6));
+	VERIFY_EQ(true, get_pixel(device, 29, 19));
+	VERIFY_EQ(true, get_pixel(device, 10, 12));
+	VERIFY_EQ(false, get_pixel(device, 11, 7));
+
+	ssd1306_line(device, (ssd1306_point_t){ 10, 6 }, (ssd1306_point_t){ 29, 19 }, ssd1306_color_invert);
+	VERIFY_EQ(false, get_pixel(device, 10, 6));
+	VERIFY_EQ(false, get_pixel(device, 29, 19));
+	VERIFY_EQ(true, get_pixel(device, 20, 13));
+
+	ssd1306_clear(device, NULL);
+
+	// within the top left 32x32 pixels, which every raster has
+	ssd1306_circle(device, (ssd1306_point_t){ 20, 20 }, 5, false, ssd1306_color_set);
+	VERIFY_EQ(true, get_pixel(device, 20, 15));
+	VERIFY_EQ(true, get_pixel(device, 25, 20));
+	VERIFY_EQ(false, get_pixel(device, 20, 20));
+
+	ssd1306_polygon(device, (const ssd1306_point_t[]){ { 0, 22 }, { 8, 22 }, { 0, 30 } }, 3, true, ssd1306_color_set);
+	VERIFY_EQ(true, get_pixel(device, 0, 22));
+	VERIFY_EQ(true, get_pixel(device, 3, 26));
+	VERIFY_EQ(false, get_pixel(device, 5, 26));
+}
+
+static void test_packed(ssd1306_t device)
+{
+	ssd1306_bitmap_t* bitmap = ssd1306_unpack(&frame_packed);
+
+	VERIFY_EQ(0, memcmp(bitmap->image, frame_bmp.image, 5));
+
+	free(bitmap);
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_draw_packed(device, &(ssd1306_bounds_t){ x0: 20, y0: 22, x1: 25, y1: 27 }, &frame_packed, ssd1306_rop_copy);
+	verify_pixels(device, 20, 22, &frame_bmp);
+
+	// clipped at the left edge
+	ssd1306_draw_packed(device, &(ssd1306_bounds_t){ x0: -2, y0: 3, x1: 3, y1: 8 }, &frame_packed, ssd1306_rop_copy);
+	VERIFY_EQ(true, get_pixel(device, 0, 3));
+	VERIFY_EQ(false, get_pixel(device, 0, 4));
+	VERIFY_EQ(true, get_pixel(device, 2, 4));
+}
+
+static void test_text(ssd1306_t device)
+{
+	ssd1306_stats_t stats;
+
+	ssd1306_stats(device, &stats, true);
+	ssd1306_clear(device, NULL);
+
+	ssd1306_text(device, &(ssd1306_bounds_t){ x0: 3, y0: 10, x1: 128, y1: 18 }, "%d%s", 42, "\x7!");
+
+	ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap(device, "%d%s", 42, "\x7!");
+
+	verify_pixels(device, 3, 10, bitmap);
+
+	// clipped at the left edge, the first glyph is partially visible
+	ssd1306_clear(device, NULL);
+	ssd1306_text(device, &(ssd1306_bounds_t){ x0: -3, y0: 20, x1: 128, y1: 28 }, "%d%s", 42, "\x7!");
+
+	for( int16_t x = 0; x < bitmap->w - 3; x++ ) {
+		for( int16_t y = 0; y < 8; y++ ) {
+			VERIFY_EQ((bitmap->image[x + 3] & (1 << y)) != 0, get_pixel(device, x, 20 + y));
+		}
+	}
+
+	free(bitmap);
+
+	// the built-in formatting agrees with the C library
+	char expected[32];
+
+	snprintf(expected, sizeof(expected), "%+3d|%-4u|%05.1f|%#x", -7, 12u, 2.5, 255u);
+
+	ssd1306_bitmap_t* formatted = ssd1306_text_bitmap(device, "%+3d|%-4u|%05.1f|%#x", -7, 12u, 2.5, 255u);
+	ssd1306_bitmap_t* literal = ssd1306_text_bitmap(device, "%s", expected);
+
+	VERIFY_EQ(literal->w, formatted->w);
+	VERIFY_EQ(0, memcmp(literal->image, formatted->image, literal->w));
+
+	const uint16_t widest = formatted->w;
+
+	free(formatted);
+	free(literal);
+
+#if CONFIG_SSD1306_TEXT_UTF8
+	// a two byte sequence and a lone Latin-1 byte decode to the same code point
+	VERIFY_EQ(ssd1306_text_width(device, "\xb0"), ssd1306_text_width(device, "\xc2\xb0"));
+	VERIFY_EQ(ssd1306_text_width(device, "A"), ssd1306_text_width(device, "\xe2\x94" "A"));
+#endif
+
+	ssd1306_stats(device, &stats, false);
+
+	VERIFY_EQ(true, stats.text_chars > 0);
+
+	// the transient buffers all came from the arena, unless it can't hold a text and its bitmap
+	const size_t needed = SSD1306_TEXT_LENGTH + 4 + sizeof(ssd1306_bitmap_t)
+		+ bytes_cap(device->font->height) * widest + 3;
+
+	if( CONFIG_SSD1306_ARENA_SIZE >= needed ) {
+		VERIFY_EQ(0, stats.arena_spills);
+		VERIFY_EQ(true, stats.arena_peak > 0);
+	} else {
+		VERIFY_EQ(true, stats.arena_spills > 0);
+	}
+}
+
+static void test_tall_text(ssd1306_t device)
+{
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	const ssd1306_font_t* font = device->font;
+
+	dev->font = (const ssd1306_font_t*)tall_fnt;
+
+	// at an unaligned row, the glyphs straddle three pages
+	ssd1306_clear(device, NULL);
+	ssd1306_rect(device, &(ssd1306_bounds_t){ x0: 0, y0: 8, x1: 16, y1: 32 }, true, ssd1306_color_set);
+	ssd1306_text(device, &(ssd1306_bounds_t){ x0: 5, y0: 11, x1: 12, y1: 27 }, "AB");
+
+	verify_pixels(device, 5, 11, &tall_bmp);
+
+	// the rows around the text are left as they were
+	for( int16_t x = 5; x < 12; x++ ) {
+		VERIFY_EQ(true, get_pixel(device, x, 10));
+		VERIFY_EQ(true, get_pixel(device, x, 27));
+	}
+
+	// rendered into a bitmap, the pages are the ones of the glyphs
+	ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap(device, "AB");
+
+	VERIFY_EQ(tall_bmp.w, bitmap->w);
+	VERIFY_EQ(tall_bmp.h, bitmap->h);
+	VERIFY_EQ(0, memcmp(tall_bmp.image, bitmap->image, 2 * tall_bmp.w));
+
+	free(bitmap);
+
+	dev->font = font;
+}
+
+static void test_layout(ssd1306_t device)
+{
+	ssd1306_layout_t layout = { 0 };
+	const uint16_t word = ssd1306_text_width(device, "word");
+
+	// two words fit a line, the third one wraps
+	VERIFY_EQ(true, ssd1306_layout(device, &layout, 2 * word + ssd1306_text_width(device, " "), "word word word"));
+	VERIFY_EQ(2, layout.lines_z);
+	VERIFY_EQ(4, layout.lines[1].length);
+	VERIFY_EQ(word, layout.lines[1].w);
+
+	// the same text isn't measured again
+	VERIFY_EQ(false, ssd1306_layout(device, &layout, layout.box_w, "%s %s %s", "word", "word", "word"));
+
+	// right aligned, the last line ends at the right edge of the box, which fits any raster
+	const ssd1306_bounds_t box = { x0: 0, y0: 0, x1: mini(100, device->w), y1: mini(40, device->h) };
+
+	ssd1306_clear(device, NULL);
+	ssd1306_draw_layout(device, &box, &layout, ssd1306_align_right | ssd1306_align_bottom);
+
+	ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap(device, "word");
+
+	verify_pixels(device, box.x1 - word, box.y1 - device->font->height, bitmap);
+
+	free(bitmap);
+
+	ssd1306_layout_free(&layout);
+}
+
+static void test_field(ssd1306_t device)
+{
+	// within the top left 32x32 pixels, which every raster has
+	ssd1306_field_t field = { bounds: { x0: 2, y0: 16, x1: 32, y1: 24 } };
+
+	ssd1306_clear(device, NULL);
+
+	for( int k = 98; k < 103; k++ ) {
+		ssd1306_field(device, &field, "%3d", k);
+
+		ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap(device, "%3d", k);
+
+		verify_pixels(device, 2, 16, bitmap);
+
+		VERIFY_EQ(bitmap->w, field.w);
+
+		free(bitmap);
+	}
+
+	// a shorter text leaves nothing behind
+	ssd1306_field(device, &field, "T");
+
+	VERIFY_EQ(false, get_pixel(device, 2 + field.w + 1, 16 + 3));
+}
+
+static void test_scaled(ssd1306_t device)
+{
+	ssd1306_clear(device, NULL);
+
+	// at an unaligned row, each pixel becomes a 3x3 block
+	ssd1306_draw_scaled(device, &(ssd1306_bounds_t){ x0: 7, y0: 11, x1: 22, y1: 26 }, &frame_bmp, 3, ssd1306_rop_copy);
+
+	for( int16_t j = 0; j < 15; j++ ) {
+		for( int16_t i = 0; i < 15; i++ ) {
+			const bool expected = frame_bmp.image[i / 3] & (1 << (j / 3));
+
+			VERIFY_EQ(expected, get_pixel(device, 7 + i, 11 + j));
+		}
+	}
+
+	VERIFY_EQ(false, get_pixel(device, 22, 11));
+	VERIFY_EQ(false, get_pixel(device, 7, 26));
+
+	// text at scale 1 matches the regular text, also at an unaligned row
+	ssd1306_clear(device, NULL);
+	ssd1306_text_scaled(device, &(ssd1306_bounds_t){ x0: 5, y0: 13, x1: device->w, y1: device->h }, 1, "%d", 42);
+
+	ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap(device, "%d", 42);
+
+	verify_pixels(device, 5, 13, bitmap);
+
+	free(bitmap);
+}
+
+static void test_label(ssd1306_t device)
+{
+	// within the top left 32x32 pixels, which every raster has
+	const ssd1306_bounds_t target = { x0: 4, y0: 21, x1: 32, y1: 32 };
+	ssd1306_bitmap_t* bitmap = ssd1306_text_bitmap(device, "RPM");
+	ssd1306_stats_t stats;
+
+	// the bitmap and the text it's keyed by, when the pool can hold them
+	const bool cached = CONFIG_SSD1306_LABEL_CACHE >= sizeof(ssd1306_bitmap_t)
+		+ bytes_cap(bitmap->h) * bitmap->w + sizeof("RPM");
+
+	ssd1306_stats(device, &stats, true);
+	ssd1306_clear(device, NULL);
+
+	// the same formatted text is the same label, however it's formatted
+	ssd1306_label(device, &target, false, "%s", "RPM");
+	ssd1306_clear(device, NULL);
+	ssd1306_label(device, &target, false, "RP%c", 'M');
+
+	verify_pixels(device, 4, 21, bitmap);
+
+	// inverted, it's another one
+	ssd1306_label(device, &target, true, "RPM");
+
+	for( int16_t j = 0; j < bitmap->h; j++ ) {
+		for( int16_t i = 0; i < bitmap->w; i++ ) {
+			const bool pixel = (bitmap->image[(j / 8) * bitmap->w + i] & (1 << (j % 8))) != 0;
+
+			VERIFY_EQ(!pixel, get_pixel(device, 4 + i, 21 + j));
+		}
+	}
+
+	ssd1306_stats(device, &stats, false);
+
+	VERIFY_EQ(cached ? 1 : 0, stats.label_hits);
+	VERIFY_EQ(cached ? 2 : 3, stats.label_misses);
+
+	free(bitmap);
+}
+
+static void test_status(ssd1306_t device)
+{
+	const ssd1306_bounds_t* bounds = ssd1306_status_bounds(device, ssd1306_status_0, NULL);
+
+	ssd1306_status(device, ssd1306_status_0, "%d", 8);
+
+	const bool pixel = get_pixel(device, bounds->x0 + 2, bounds->y0 + 3);
+
+	// the same text again leaves the line alone, even when drawn over
+	ssd1306_rect(device, bounds, true, ssd1306_color_invert);
+	ssd1306_status(device, ssd1306_status_0, "%d", 8);
+
+	VERIFY_EQ(!pixel, get_pixel(device, bounds->x0 + 2, bounds->y0 + 3));
+
+	// once cleared, it's drawn again
+	ssd1306_clear(device, bounds);
+	ssd1306_status(device, ssd1306_status_0, "%d", 8);
+
+	VERIFY_EQ(pixel, get_pixel(device, bounds->x0 + 2, bounds->y0 + 3));
+
+	ssd1306_status(device, ssd1306_status_0, NULL);
+}
+
+static void verify_ticker(ssd1306_t device, ssd1306_ticker_t ticker, const ssd1306_bitmap_t* bitmap, uint16_t position)
+{
+	const ssd1306_bounds_t* bounds = &ticker->bounds;
+	const bool vertical = ticker->config.direction >= ssd1306_ticker_up;
+	const bool forward = ticker->config.direction == ssd1306_ticker_left || ticker->config.direction == ssd1306_ticker_up;
+	const int16_t period = vertical ? bitmap->h : bitmap->w;
+
+	// the band shows the content from position on, which comes in from the right or the bottom when moving forward
+	const int16_t shift = forward ? position : (period - position) % period;
+
+	VERIFY_EQ(position, ticker->position);
+
+	for( int16_t j = 0; j < ssd1306_bounds_height(bounds); j++ ) {
+		for( int16_t i = 0; i < ssd1306_bounds_width(bounds); i++ ) {
+			const int16_t u = vertical ? i : (i + shift) % period;
+			const int16_t v = vertical ? (j + shift) % period : j;
+			const bool expected = (bitmap->image[(v / 8) * bitmap->w + u] & (1 << (v % 8))) != 0;
+
+			VERIFY_EQ(expected, get_pixel(device, bounds->x0 + i, bounds->y0 + j));
+		}
+	}
+}
+
+static void test_ticker(ssd1306_t device)
+{
+	// 20 pixels per second, one every 50 ms after the pause
+	const uint16_t speed = 20;
+	const uint16_t pause = 100;
+
+	for( ssd1306_ticker_direction_t direction = ssd1306_ticker_left; direction <= ssd1306_ticker_down; direction++ ) {
+		const bool vertical = direction >= ssd1306_ticker_up;
+		const ssd1306_ticker_config_t config = { speed: speed, pause_ms: pause, direction: direction };
+		const ssd1306_bounds_t bounds = vertical
+			? (ssd1306_bounds_t){ x0: 10, y0: 3, x1: 15, y1: 6 }
+			: (ssd1306_bounds_t){ x0: 10, y0: 3, x1: 13, y1: 8 };
+		ssd1306_ticker_t ticker = ssd1306_create_ticker(device, &bounds, &config);
+
+		// the content starts at the top-left of the band, what doesn't fit waits its turn
+		ssd1306_clear(device, NULL);
+		ssd1306_ticker_bitmap(device, ticker, &cross_bmp);
+		ssd1306_update(device);
+
+		verify_ticker(device, ticker, &cross_bmp, 0);
+		VERIFY_EQ(false, vertical ? get_pixel(device, 12, 6) : get_pixel(device, 13, 5));
+
+		// past the pause and two steps, halfway to the third one
+		vTaskDelay(pdMS_TO_TICKS(pause + 2 * 1000 / speed + 30));
+
+		VERIFY_EQ(true, ssd1306_acquire(device));
+		verify_ticker(device, ticker, &cross_bmp, 2);
+
+		// content of the same size carries on from there
+		ssd1306_ticker_bitmap(device, ticker, &frame_bmp);
+		verify_ticker(device, ticker, &frame_bmp, 2);
+
+		ssd1306_release(device);
+
+		// three steps later it's back at the start, where it pauses again
+		vTaskDelay(pdMS_TO_TICKS(3 * 1000 / speed + 40));
+
+		VERIFY_EQ(true, ssd1306_acquire(device));
+		verify_ticker(device, ticker, &frame_bmp, 0);
+
+		ssd1306_release(device);
+		ssd1306_free_ticker(device, ticker);
+	}
+}
+
+static void test_grayscale(ssd1306_t device)
+{
+	if( !device->grayscale ) {
+		return; // the device wasn't initialised with init->grayscale
+	}
+
+	const ssd1306_bounds_t bounds = { x0: 20, y0: 22, x1: 25, y1: 27 };
+	const uint8_t* plane0 = ssd1306_raster(device, 0);
+
+	ssd1306_select_plane(device, 1);
+	ssd1306_clear(device, NULL);
+	ssd1306_draw(device, &bounds, &cross_bmp);
+
+	VERIFY_EQ(true, plane0 != ssd1306_raster(device, 0));
+
+	ssd1306_select_plane(device, 0);
+	ssd1306_clear(device, NULL);
+	ssd1306_draw(device, &bounds, &frame_bmp);
+
+	// each plane holds its own drawing
+	VERIFY_EQ(true, plane0 == ssd1306_raster(device, 0));
+	verify_pixels(device, 20, 22, &frame_bmp);
+
+	ssd1306_select_plane(device, 1);
+	verify_pixels(device, 20, 22, &cross_bmp);
+
+	// switched back, plane 0 is drawn into again and plane 1 is left alone
+	ssd1306_select_plane(device, 0);
+	ssd1306_clear(device, NULL);
+
+	VERIFY_EQ(false, get_pixel(device, 22, 24));
+
+	ssd1306_select_plane(device, 1);
+	VERIFY_EQ(true, get_pixel(device, 22, 24));
+
+	ssd1306_select_plane(device, 0);
+
+	// the task shows plane 1 during subframes 0 and 1, plane 0 during subframe 2, and sends the changes along
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+	ssd1306_stats_t stats;
+	bool shown[2] = { false, false };
+
+	ssd1306_stats(device, &stats, true);
+	ssd1306_update(device);
+
+	for( unsigned k = 0; k < 30; k++ ) {
+		vTaskDelay(pdMS_TO_TICKS(10));
+
+		VERIFY_EQ(true, ssd1306_acquire(device));
+		VERIFY_EQ(dev->gray.subframe < 2 ? 1 : 0, dev->gray.shown);
+		VERIFY_EQ(false, dev->gray.dirty);
+
+		shown[dev->gray.shown] = true;
+
+		ssd1306_release(device);
+	}
+
+	VERIFY_EQ(true, shown[0]);
+	VERIFY_EQ(true, shown[1]);
+
+	ssd1306_stats(device, &stats, false);
+	VERIFY_EQ(true, stats.cycles > 0);
+}
+
+static void test_portrait(ssd1306_t device)
+{
+	// the frame drawn at 11,21 covers the tile at 8,16 from its row 5 and column 3 on
+	const uint8_t expected[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x88, 0x88 };
+	uint8_t tile[8];
+
+	if( device->portrait ) {
+		VERIFY_EQ(128, device->h);
+		VERIFY_EQ(true, device->w == 32 || device->w == 64);
+	}
+
+	ssd1306_clear(device, NULL);
+	ssd1306_draw(device, &(ssd1306_bounds_t){ x0: 11, y0: 21, x1: 16, y1: 26 }, &frame_bmp);
+
+	ssd1306_transpose8(ssd1306_raster(device, 2) + 8, 1, tile, 1);
+
+	VERIFY_EQ(0, memcmp(expected, tile, sizeof(tile)));
+
+	if( !device->portrait ) {
+		return;
+	}
+
+	// once updated, raster page 2 and tile column 1 are frame page 1 and tile column 2
+	ssd1306_int_t dev = (ssd1306_int_t)device;
+
+	ssd1306_update(device);
+	vTaskDelay(pdMS_TO_TICKS(50));
+
+	VERIFY_EQ(true, ssd1306_acquire(device));
+	VERIFY_EQ(0, memcmp(expected, dev->frame + 1 * dev->panel.w + 2 * 8, sizeof(expected)));
+
+	ssd1306_release(device);
+}
+
+static const uint8_t tile_atlas[3 * 8] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0xff, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xff,
+	0x01, 0x03, 0x07, 0x0f, 0x1f, 0x3f, 0x7f, 0xf0,
+};
+
+static void verify_tilemap(ssd1306_t device, const ssd1306_bounds_t* bounds, const uint8_t cells[2][2],
+		int16_t sx, int16_t sy)
+{
+	for( int16_t y = bounds->y0; y < bounds->y1; y++ ) {
+		for( int16_t x = bounds->x0; x < bounds->x1; x++ ) {
+			const int16_t mx = (x - bounds->x0 + sx) % 16;
+			const int16_t my = (y - bounds->y0 + sy) % 16;
+			const bool expected = (tile_atlas[cells[my / 8][mx / 8] * 8 + mx % 8] & (1 << (my % 8))) != 0;
+
+			VERIFY_EQ(expected, get_pixel(device, x, y));
+		}
+	}
+}
+
+static void test_tilemap(ssd1306_t device)
+{
+	// a 2x2 map exactly covers the region, so scrolling wraps it around
+	const ssd1306_bounds_t bounds = { x0: 8, y0: 16, x1: 24, y1: 32 };
+	const uint8_t cells[2][2] = { { 1, 2 }, { 2, 0 } };
+
+	ssd1306_clear(device, NULL);
+
+	ssd1306_tilemap_t map = ssd1306_create_tilemap(device, &bounds, 2, 2, tile_atlas, 3);
+
+	for( uint8_t row = 0; row < 2; row++ ) {
+		for( uint8_t col = 0; col < 2; col++ ) {
+			ssd1306_tilemap_set(device, map, col, row, cells[row][col]);
+		}
+	}
+
+	ssd1306_update(device);
+	vTaskDelay(pdMS_TO_TICKS(50));
+
+	VERIFY_EQ(true, ssd1306_acquire(device));
+	verify_tilemap(device, &bounds, cells, 0, 0);
+	ssd1306_release(device);
+
+	ssd1306_tilemap_scroll(device, map, 3, 5);
+
+	ssd1306_update(device);
+	vTaskDelay(pdMS_TO_TICKS(50));
+
+	VERIFY_EQ(true, ssd1306_acquire(device));
+	verify_tilemap(device, &bounds, cells, 3, 5);
+	VERIFY_EQ(false, get_pixel(device, bounds.x1, bounds.y0));
+	ssd1306_release(device);
+
+	ssd1306_free_tilemap(device, map);
+}
+
+static void test_sprite(ssd1306_t device)
+{
+	if( !ssd1306_register_sprite(device, &cross_bmp) ) {
+		return; // the shift cache is disabled
+	}
+
+	ssd1306_stats_t stats;
+
+	ssd1306_stats(device, &stats, true);
+
+	for( int k = 0; k < 2; k++ ) {
+		ssd1306_clear(device, NULL);
+		ssd1306_draw(device, &(ssd1306_bounds_t){ x0: 10, y0: 13, x1: 15, y1: 18 }, &cross_bmp);
+
+		verify_pixels(device, 10, 13, &cross_bmp);
+	}
+
+	// shifted once, then found in the cache
+	ssd1306_stats(device, &stats, false);
+
+	VERIFY_EQ(1, stats.shift_misses);
+	VERIFY_EQ(1, stats.shift_hits);
+
+	ssd1306_unregister_sprite(device, &cross_bmp);
+}
+
+void test_draw(ssd1306_t device)
+{
+	LOG_I("testing draw");
+
+	ssd1306_auto_update(device, false);
+
+	test_rop(device);
+	test_masked(device);
+	test_sheet(device);
+	test_transformed(device);
+	test_scroll(device);
+	test_fill(device);
+	test_shapes(device);
+	test_packed(device);
+	test_text(device);
+	test_tall_text(device);
+	test_layout(device);
+	test_field(device);
+	test_scaled(device);
+	test_label(device);
+	test_status(device);
+	test_ticker(device);
+	test_grayscale(device);
+	test_portrait(device);
+	test_tilemap(device);
+	test_sprite(device);
+
+	ssd1306_auto_update(device, true);
+	ssd1306_clear(device, NULL);
+}